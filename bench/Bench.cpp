@@ -0,0 +1,120 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Bench.cpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 13:52:07 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 13:52:07 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+#include <cstdio>
+#include <new>
+
+volatile size_t g_bench_sink = 0;
+
+static unsigned long g_allocations = 0;
+
+// Every heap allocation of the benchmark binary goes through here
+void *operator new(size_t size) throw(std::bad_alloc)
+{
+	g_allocations++;
+	void *pointer = malloc(size ? size : 1);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void operator delete(void *pointer) throw()
+{
+	free(pointer);
+}
+
+unsigned long benchAllocations(void)
+{
+	return g_allocations;
+}
+
+double benchClock(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+void benchSilenceLogs(void)
+{
+	logSetLevel(ERR + 1);
+}
+
+double benchRun(std::string const &name, BenchBody body, void *context)
+{
+	size_t iterations = 1;
+	double elapsed = 0;
+	unsigned long allocations = 0;
+
+	// Aim for at least 100ms of measured work
+	while (true)
+	{
+		unsigned long allocated = benchAllocations();
+		double start = benchClock();
+		body(context, iterations);
+		elapsed = benchClock() - start;
+		allocations = benchAllocations() - allocated;
+		if (elapsed >= 1e8 || iterations >= (static_cast<size_t>(1) << 30))
+			break;
+		iterations *= 2;
+	}
+
+	double ns_per_op = elapsed / iterations;
+	printf("%-44s %12lu iters %12.1f ns/op %8.2f allocs/op\n", name.c_str(), \
+		static_cast<unsigned long>(iterations), ns_per_op, \
+		static_cast<double>(allocations) / iterations);
+	return ns_per_op;
+}
+
+void BenchAccess::addChannel(Server &server, Channel *channel)
+{
+	server._channels.insert(channel->getName(), channel);
+}
+
+// Event loop state of the calling thread, without a listening socket
+Shard *BenchAccess::addShard(Server &server)
+{
+	Shard *shard = new Shard(&server, static_cast<int>(server._shards.size()));
+	shard->reactor = Reactor::create();
+	server._shards.push_back(shard);
+	Server::_enterShard(shard);
+	return shard;
+}
+
+Client *BenchAccess::addClient(Server &server, Shard *shard, int fd, \
+	std::string const &nick)
+{
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	server._addClient(shard, fd, addr);
+
+	Client *client = server.getClient(fd);
+	if (client)
+	{
+		server._setNickname(client, nick);
+		client->setUsername(nick);
+	}
+	return client;
+}
+
+// Indexes the nickname the way a registration does
+void BenchAccess::setNick(Server &server, Client *client, \
+	std::string const &nick)
+{
+	server._setNickname(client, nick);
+}
+
+void BenchAccess::endOfTick(Server &server)
+{
+	server._endOfTick();
+}
@@ -0,0 +1,54 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Bench.hpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 13:48:20 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 13:48:20 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include "../include/Server.hpp"
+
+// Body of a benchmark: runs the measured operation `iterations` times
+typedef void (*BenchBody)(void *context, size_t iterations);
+
+// Monotonic clock in nanoseconds
+double benchClock(void);
+
+// Heap allocations made so far (operator new is replaced in the bench)
+unsigned long benchAllocations(void);
+
+// Drops logMessage() output so it doesn't pollute timings
+void benchSilenceLogs(void);
+
+// Grows the iteration count until the run is long enough to time, then
+// prints the cost of one operation (nanoseconds and heap allocations) and
+// returns the nanoseconds
+double benchRun(std::string const &name, BenchBody body, void *context);
+
+// Written to by benchmark bodies so the compiler keeps the measured work
+extern volatile size_t g_bench_sink;
+
+// Friend of the server classes, builds in-process state without sockets
+class BenchAccess
+{
+	public:
+		static void addChannel(Server &server, Channel *channel);
+		static Shard *addShard(Server &server);
+		static Client *addClient(Server &server, Shard *shard, int fd, \
+			std::string const &nick);
+		static void setNick(Server &server, Client *client, \
+			std::string const &nick);
+		static void endOfTick(Server &server);
+};
+
+// Benchmark suites
+void benchLookups(void);
+void benchAlloc(void);
+void benchReply(void);
+void benchParser(void);
@@ -0,0 +1,142 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BenchAlloc.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 20:46:09 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 20:46:09 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+#include <cstdio>
+
+#define FANOUT_WARMUP	8	// Rounds that let the queues reach their size
+#define FANOUT_ROUNDS	64	// Rounds whose allocations are counted
+
+struct FanoutContext
+{
+	Server *server;
+	int sender_fd;
+	Client *sender;
+	Channel *channel;
+	std::vector<int> peers; // Our ends of the members' sockets
+	std::string line;
+};
+
+// Reads back what the server wrote so the sockets never fill up
+static void drainPeers(FanoutContext *ctx)
+{
+	char buffer[4096];
+
+	for (size_t i = 0; i < ctx->peers.size(); i++)
+	{
+		while (recv(ctx->peers[i], buffer, sizeof(buffer), MSG_DONTWAIT) > 0)
+			;
+	}
+}
+
+// One PRIVMSG, handled and written out the way an event loop tick does
+static void fanoutRound(FanoutContext *ctx)
+{
+	IrcMessage message(ctx->line.data(), ctx->line.size());
+	ctx->server->privmsgCommand(message, ctx->sender_fd);
+	BenchAccess::endOfTick(*ctx->server);
+}
+
+static void fanoutBody(void *context, size_t iterations)
+{
+	FanoutContext *ctx = static_cast<FanoutContext *>(context);
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		fanoutRound(ctx);
+		drainPeers(ctx);
+	}
+}
+
+// Channel::sendMessage alone, without parsing and target checks
+static void channelSendBody(void *context, size_t iterations)
+{
+	FanoutContext *ctx = static_cast<FanoutContext *>(context);
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		ctx->channel->sendMessage(ctx->server, ctx->sender, \
+			":the quick brown fox jumps over the lazy dog", "PRIVMSG");
+		BenchAccess::endOfTick(*ctx->server);
+		drainPeers(ctx);
+	}
+}
+
+// Allocations per channel message must not grow with the member count
+static void benchFanout(size_t recipients)
+{
+	Server server(0, "bench");
+	Shard *shard = BenchAccess::addShard(server);
+	Channel *channel = new Channel("bench");
+	FanoutContext ctx;
+	std::vector<int> fds;
+
+	BenchAccess::addChannel(server, channel);
+	ctx.server = &server;
+	ctx.channel = channel;
+	ctx.line = "PRIVMSG #bench :the quick brown fox jumps over the lazy dog";
+
+	// Member 0 is the sender, socketpairs stand in for the connections
+	for (size_t i = 0; i <= recipients; i++)
+	{
+		int pair[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == -1)
+		{
+			perror("socketpair");
+			break;
+		}
+		fcntl(pair[0], F_SETFL, O_NONBLOCK);
+		fds.push_back(pair[0]);
+		fds.push_back(pair[1]);
+
+		Client *client = BenchAccess::addClient(server, shard, pair[0], \
+			"member" + itoa(i));
+		channel->addUser(client);
+		if (i == 0)
+		{
+			ctx.sender_fd = pair[0];
+			ctx.sender = client;
+		}
+		else
+			ctx.peers.push_back(pair[1]);
+	}
+
+	std::string label = "PRIVMSG #chan (" + itoa(ctx.peers.size()) \
+		+ " recipients)";
+	benchRun(label, fanoutBody, &ctx);
+	benchRun("Channel::sendMessage (" + itoa(ctx.peers.size()) \
+		+ " recipients)", channelSendBody, &ctx);
+
+	fanoutBody(&ctx, FANOUT_WARMUP);
+	unsigned long allocations = 0;
+	for (size_t i = 0; i < FANOUT_ROUNDS; i++)
+	{
+		unsigned long before = benchAllocations();
+		fanoutRound(&ctx);
+		allocations += benchAllocations() - before;
+		drainPeers(&ctx);
+	}
+	double per_message = static_cast<double>(allocations) / FANOUT_ROUNDS;
+	printf("%-44s %12.1f allocs/msg %9.3f allocs/recipient\n", \
+		label.c_str(), per_message, per_message / ctx.peers.size());
+
+	server.cleanUp();
+	for (size_t i = 0; i < fds.size(); i++)
+		close(fds[i]);
+}
+
+void benchAlloc(void)
+{
+	benchFanout(10);
+	benchFanout(100);
+	benchFanout(1000);
+}
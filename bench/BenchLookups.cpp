@@ -0,0 +1,114 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BenchLookups.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 13:58:41 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 13:58:41 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+#define LOOKUP_KEYS 1024
+
+struct ChannelLookupContext
+{
+	Server *server;
+	std::vector<std::string> names;
+};
+
+static void channelLookupBody(void *context, size_t iterations)
+{
+	ChannelLookupContext *ctx = static_cast<ChannelLookupContext *>(context);
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		Channel *channel = ctx->server->getChannelByName( \
+			ctx->names[i & (LOOKUP_KEYS - 1)]);
+		g_bench_sink += reinterpret_cast<size_t>(channel);
+	}
+}
+
+// getChannelByName cost must not grow with the number of channels
+static void benchChannelLookup(size_t channel_count)
+{
+	Server server(0, "bench");
+	ChannelLookupContext ctx;
+
+	ctx.server = &server;
+	for (size_t i = 0; i < channel_count; i++)
+		BenchAccess::addChannel(server, new Channel("chan" + itoa(i)));
+
+	// Existing names, looked up with a different case than stored
+	srand(42);
+	for (size_t i = 0; i < LOOKUP_KEYS; i++)
+		ctx.names.push_back("CHAN" + itoa(rand() % channel_count));
+
+	benchRun("getChannelByName (" + itoa(channel_count) + " channels)", \
+		channelLookupBody, &ctx);
+	server.cleanUp();
+}
+
+struct NickLookupContext
+{
+	Server *server;
+	std::vector<std::string> nicks;
+};
+
+static void nickLookupBody(void *context, size_t iterations)
+{
+	NickLookupContext *ctx = static_cast<NickLookupContext *>(context);
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		Client *client = ctx->server->getClientByNick( \
+			ctx->nicks[i & (LOOKUP_KEYS - 1)]);
+		g_bench_sink += reinterpret_cast<size_t>(client);
+	}
+}
+
+// Same for getClientByNick, the clients are only in the nick index
+static void benchNickLookup(size_t client_count)
+{
+	Server server(0, "bench");
+	NickLookupContext ctx;
+	std::vector<Client *> clients;
+	sockaddr_in addr;
+
+	memset(&addr, 0, sizeof(addr));
+	ctx.server = &server;
+	for (size_t i = 0; i < client_count; i++)
+	{
+		clients.push_back(new Client(-1, addr));
+		BenchAccess::setNick(server, clients.back(), "user" + itoa(i));
+	}
+
+	// Mostly hits, one in eight misses like a typo'd PRIVMSG target
+	srand(42);
+	for (size_t i = 0; i < LOOKUP_KEYS; i++)
+	{
+		if (i % 8 == 0)
+			ctx.nicks.push_back("nobody" + itoa(i));
+		else
+			ctx.nicks.push_back("user" + itoa(rand() % client_count));
+	}
+
+	benchRun("getClientByNick (" + itoa(client_count) + " clients)", \
+		nickLookupBody, &ctx);
+	server.cleanUp();
+	for (size_t i = 0; i < clients.size(); i++)
+		delete clients[i];
+}
+
+void benchLookups(void)
+{
+	benchChannelLookup(10);
+	benchChannelLookup(1000);
+	benchChannelLookup(100000);
+	benchNickLookup(10);
+	benchNickLookup(1000);
+	benchNickLookup(100000);
+}
@@ -0,0 +1,126 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BenchParser.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 23:05:41 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 23:05:41 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+#define ASSEMBLY_LINES	16	// Lines in one "read" of the batched case
+#define SPLIT_READ		37	// Read size that cuts lines at odd places
+
+struct AssemblyContext
+{
+	Client *client;
+	std::string input;	// Bytes handed to appendBuffer() per operation
+	size_t read_size;
+	size_t offset;		// Where the next split read starts
+};
+
+// One recv() worth of input, then every complete line taken out
+static void assemblyBody(void *context, size_t iterations)
+{
+	AssemblyContext *ctx = static_cast<AssemblyContext *>(context);
+	LineView line;
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		ctx->client->appendBuffer(ctx->input.data(), ctx->input.size());
+		while (ctx->client->getNextCompleteMessage(line))
+			g_bench_sink += line.length;
+	}
+}
+
+// A stream cut into reads that end mid line, so lines span appends and
+// wrap around the ring
+static void splitAssemblyBody(void *context, size_t iterations)
+{
+	AssemblyContext *ctx = static_cast<AssemblyContext *>(context);
+	LineView line;
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		if (ctx->offset + ctx->read_size > ctx->input.size())
+			ctx->offset = 0;
+		ctx->client->appendBuffer(ctx->input.data() + ctx->offset, \
+			ctx->read_size);
+		ctx->offset += ctx->read_size;
+		while (ctx->client->getNextCompleteMessage(line))
+			g_bench_sink += line.length;
+	}
+}
+
+static void benchAssembly(void)
+{
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	Client client(-1, addr);
+	AssemblyContext ctx;
+	std::string line = "PRIVMSG #general :the quick brown fox jumps over " \
+		"the lazy dog\r\n";
+
+	ctx.client = &client;
+	ctx.input = line;
+	benchRun("appendBuffer+lines (1 line/read)", assemblyBody, &ctx);
+
+	ctx.input.clear();
+	for (size_t i = 0; i < ASSEMBLY_LINES; i++)
+		ctx.input += line;
+	benchRun("appendBuffer+lines (" + itoa(ASSEMBLY_LINES) + " lines/read)", \
+		assemblyBody, &ctx);
+
+	// Whole reads of SPLIT_READ bytes, the stream restarts on a line start
+	ctx.input.clear();
+	while (ctx.input.size() < LINE_BUFFER_SIZE * 4)
+		ctx.input += line;
+	ctx.input.resize(ctx.input.size() / (line.size() * SPLIT_READ) \
+		* line.size() * SPLIT_READ);
+	ctx.read_size = SPLIT_READ;
+	ctx.offset = 0;
+	client.cleanBuffer();
+	benchRun("appendBuffer+lines (" + itoa(SPLIT_READ) + " byte reads)", \
+		splitAssemblyBody, &ctx);
+}
+
+struct ParseContext
+{
+	std::string line;
+};
+
+static void parseBody(void *context, size_t iterations)
+{
+	ParseContext *ctx = static_cast<ParseContext *>(context);
+	IrcMessage message;
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		message.parse(ctx->line.data(), ctx->line.size());
+		g_bench_sink += message.paramCount();
+	}
+}
+
+// Tokenizing replaced parseCommand()/_splitMessage(), this is that step
+static void benchParse(std::string const &label, std::string const &line)
+{
+	ParseContext ctx;
+
+	ctx.line = line;
+	benchRun("IrcMessage::parse " + label, parseBody, &ctx);
+}
+
+void benchParser(void)
+{
+	benchAssembly();
+	benchParse("PRIVMSG", "PRIVMSG #general :the quick brown fox jumps " \
+		"over the lazy dog");
+	benchParse("prefixed PRIVMSG", ":somebody!someuser@127.0.0.1 PRIVMSG " \
+		"#general :the quick brown fox jumps over the lazy dog");
+	benchParse("MODE", "MODE #general +kl secret 10");
+	benchParse("JOIN list", "JOIN #a,#b,#c,#d key1,key2");
+}
@@ -0,0 +1,98 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BenchReply.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 21:52:13 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 21:52:13 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+struct ReplyContext
+{
+	std::string server;
+	std::string nick;
+	std::string prefix;
+	std::string channel;
+	std::string error;
+	std::string text;
+};
+
+// Numeric the way _sendErrorReply() used to build it
+static void numericStreamBody(void *context, size_t iterations)
+{
+	ReplyContext *ctx = static_cast<ReplyContext *>(context);
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		std::ostringstream oss;
+		oss << ":" << ctx->server << " " << std::setfill('0') << std::setw(3) \
+			<< ERR_NOSUCHCHANNEL << " " << ctx->nick << " :" << ctx->error \
+			<< "\r\n";
+		SharedMessage line(oss.str());
+		g_bench_sink += line.length();
+	}
+}
+
+static void numericReplyBody(void *context, size_t iterations)
+{
+	ReplyContext *ctx = static_cast<ReplyContext *>(context);
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		Reply reply;
+		reply.numeric(ctx->server, ERR_NOSUCHCHANNEL, ctx->nick) \
+			.trailing(ctx->error);
+		SharedMessage line(reply.data(), reply.length());
+		g_bench_sink += line.length();
+	}
+}
+
+// Relayed channel message through an operator+ chain
+static void relayConcatBody(void *context, size_t iterations)
+{
+	ReplyContext *ctx = static_cast<ReplyContext *>(context);
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		SharedMessage line(ctx->prefix + " PRIVMSG #" + ctx->channel + " " \
+			+ ctx->text + "\r\n");
+		g_bench_sink += line.length();
+	}
+}
+
+static void relayReplyBody(void *context, size_t iterations)
+{
+	ReplyContext *ctx = static_cast<ReplyContext *>(context);
+
+	for (size_t i = 0; i < iterations; i++)
+	{
+		Reply reply;
+		reply.source(ctx->prefix).word("PRIVMSG").channel(ctx->channel) \
+			.word(ctx->text);
+		SharedMessage line(reply.data(), reply.length());
+		g_bench_sink += line.length();
+	}
+}
+
+// Old and new ways of producing a queued line, same bytes out
+void benchReply(void)
+{
+	ReplyContext ctx;
+
+	ctx.server = "ircserv";
+	ctx.nick = "somebody";
+	ctx.prefix = ":somebody!someuser@127.0.0.1";
+	ctx.channel = "general";
+	ctx.error = "#general :No such channel";
+	ctx.text = ":the quick brown fox jumps over the lazy dog";
+
+	benchRun("numeric: ostringstream", numericStreamBody, &ctx);
+	benchRun("numeric: Reply", numericReplyBody, &ctx);
+	benchRun("relayed PRIVMSG: operator+", relayConcatBody, &ctx);
+	benchRun("relayed PRIVMSG: Reply", relayReplyBody, &ctx);
+}
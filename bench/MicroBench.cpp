@@ -0,0 +1,32 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MicroBench.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 14:03:19 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 14:03:19 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+#include <cstdio>
+
+int main(void)
+{
+	benchSilenceLogs();
+
+	printf("== lookups ==\n");
+	benchLookups();
+
+	printf("\n== allocations ==\n");
+	benchAlloc();
+
+	printf("\n== replies ==\n");
+	benchReply();
+
+	printf("\n== input ==\n");
+	benchParser();
+	return (0);
+}
@@ -0,0 +1,79 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Histogram.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 22:10:52 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 22:10:52 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "IrcBench.hpp"
+
+#define HIST_SUB_MASK	((1UL << HIST_SUB_BITS) - 1)
+
+Histogram::Histogram() : _buckets(HIST_BUCKETS, 0), _count(0), _max(0)
+{
+}
+
+// Small values get a bucket each, larger ones share 32 buckets per power
+// of two, so the error stays proportional to the value
+size_t Histogram::_bucketOf(unsigned long value)
+{
+	if (value < HIST_LINEAR)
+		return value;
+
+	size_t msb = sizeof(unsigned long) * 8 - 1 - __builtin_clzl(value);
+	size_t sub = (value >> (msb - HIST_SUB_BITS)) & HIST_SUB_MASK;
+	return HIST_LINEAR + (msb - 6) * (1 << HIST_SUB_BITS) + sub;
+}
+
+unsigned long Histogram::_lowerBound(size_t bucket)
+{
+	if (bucket < HIST_LINEAR)
+		return bucket;
+
+	size_t msb = 6 + (bucket - HIST_LINEAR) / (1 << HIST_SUB_BITS);
+	size_t sub = (bucket - HIST_LINEAR) % (1 << HIST_SUB_BITS);
+	return ((1UL << HIST_SUB_BITS) + sub) << (msb - HIST_SUB_BITS);
+}
+
+void Histogram::record(unsigned long value)
+{
+	this->_buckets[_bucketOf(value)]++;
+	this->_count++;
+	if (value > this->_max)
+		this->_max = value;
+}
+
+// Lower bound of the bucket holding the value at that rank, 0 when empty
+unsigned long Histogram::percentile(double fraction) const
+{
+	if (this->_count == 0)
+		return 0;
+
+	unsigned long rank = static_cast<unsigned long>(fraction * this->_count);
+	if (rank >= this->_count)
+		rank = this->_count - 1;
+
+	unsigned long seen = 0;
+	for (size_t i = 0; i < this->_buckets.size(); i++)
+	{
+		seen += this->_buckets[i];
+		if (seen > rank)
+			return _lowerBound(i);
+	}
+	return this->_max;
+}
+
+unsigned long Histogram::count() const
+{
+	return this->_count;
+}
+
+unsigned long Histogram::max() const
+{
+	return this->_max;
+}
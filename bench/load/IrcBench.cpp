@@ -0,0 +1,157 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IrcBench.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 22:10:52 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 22:10:52 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "IrcBench.hpp"
+#include "../../include/Utils.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/resource.h>
+
+static bool parseCount(std::string const &value, size_t &out)
+{
+	if (value.empty() || !isNum(value) || value[0] == '-' || value[0] == '+')
+		return (false);
+	out = strtoul(value.c_str(), NULL, 10);
+	return (true);
+}
+
+// Optional settings given as --name=value after port and password
+static bool parseOptions(int argc, char **argv, LoadConfig &config)
+{
+	for (int i = 3; i < argc; i++)
+	{
+		std::string option = argv[i];
+		size_t equal = option.find('=');
+		std::string name = option.substr(0, equal);
+		std::string value = (equal == std::string::npos) ? "" \
+			: option.substr(equal + 1);
+		bool valid = false;
+
+		if (name == "--host")
+		{
+			config.host = value;
+			valid = !value.empty();
+		}
+		else if (name == "--clients")
+			valid = parseCount(value, config.clients) && config.clients > 0;
+		else if (name == "--channels")
+			valid = parseCount(value, config.channels) && config.channels > 0;
+		else if (name == "--distribution")
+		{
+			config.zipf = (value == "zipf");
+			valid = config.zipf || value == "uniform";
+		}
+		else if (name == "--rate")
+			valid = parseCount(value, config.rate) && config.rate > 0;
+		else if (name == "--duration")
+			valid = parseCount(value, config.duration) && config.duration > 0;
+		else if (name == "--notice")
+			valid = parseCount(value, config.notice_percent) \
+				&& config.notice_percent <= 100;
+		else if (name == "--setup-timeout")
+			valid = parseCount(value, config.setup_timeout) \
+				&& config.setup_timeout > 0;
+
+		if (!valid)
+		{
+			fprintf(stderr, "Invalid option: %s\n", option.c_str());
+			return (false);
+		}
+	}
+	return (true);
+}
+
+// Every simulated client is a socket, the soft limit is usually 1024
+static void raiseFileLimit(size_t clients)
+{
+	struct rlimit limit;
+
+	if (getrlimit(RLIMIT_NOFILE, &limit) == -1)
+		return;
+	limit.rlim_cur = limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+	if (limit.rlim_cur != RLIM_INFINITY && clients + 16 > limit.rlim_cur)
+		fprintf(stderr, "Warning: open file limit %lu is below %lu clients\n", \
+			static_cast<unsigned long>(limit.rlim_cur), \
+			static_cast<unsigned long>(clients));
+}
+
+static double perSecond(unsigned long count, unsigned long us)
+{
+	return us ? count * 1000000.0 / us : 0;
+}
+
+static void report(LoadConfig const &config, LoadRun const &run)
+{
+	printf("clients      %lu registered, %lu failed, %lu dropped\n", \
+		static_cast<unsigned long>(run.registered), \
+		static_cast<unsigned long>(run.failed), \
+		static_cast<unsigned long>(run.dropped));
+	printf("setup        %.0f conn/s, registration p50 %lu us, p99 %lu us, " \
+		"all joined in %lu ms\n", perSecond(run.registered, run.setup_us), \
+		run.setup_latency.percentile(0.50), run.setup_latency.percentile(0.99), \
+		run.join_us / 1000);
+	printf("load         %lu channels (%s), %lu messages in %.1f s, " \
+		"%.0f msgs/s sent, %.0f msgs/s delivered\n", \
+		static_cast<unsigned long>(config.channels), \
+		config.zipf ? "zipf" : "uniform", run.sent, run.load_us / 1e6, \
+		perSecond(run.sent, run.load_us), perSecond(run.delivered, run.load_us));
+	printf("deliveries   %lu of %lu expected\n", run.delivered, run.expected);
+	printf("latency      p50 %lu us, p99 %lu us, p999 %lu us, max %lu us\n", \
+		run.delivery_latency.percentile(0.50), \
+		run.delivery_latency.percentile(0.99), \
+		run.delivery_latency.percentile(0.999), run.delivery_latency.max());
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Try ./ircbench <port> <password> [--host=<ip>] " \
+			"[--clients=<count>] [--channels=<count>] " \
+			"[--distribution=uniform|zipf] [--rate=<msgs/s>] " \
+			"[--duration=<s>] [--notice=<percent>] [--setup-timeout=<s>]\n");
+		return (-1);
+	}
+
+	LoadConfig config;
+	config.password = argv[2];
+	config.port = atoi(argv[1]);
+	if (!isNum(argv[1]) || !isValidPort(config.port))
+	{
+		fprintf(stderr, "Invalid port number!\n");
+		return (-1);
+	}
+	if (!parseOptions(argc, argv, config))
+		return (-1);
+
+	signal(SIGPIPE, SIG_IGN);
+	raiseFileLimit(config.clients);
+
+	LoadRun run(config);
+	if (!run.setup())
+	{
+		fprintf(stderr, "No client could register and join\n");
+		report(config, run);
+		return (1);
+	}
+	bool completed = run.load();
+	report(config, run);
+	if (!completed)
+	{
+		fprintf(stderr, "Every client was disconnected during the load\n");
+		return (1);
+	}
+	return (0);
+}
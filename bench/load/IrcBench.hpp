@@ -0,0 +1,140 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IrcBench.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 22:10:52 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 22:10:52 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "../../include/Reactor.hpp"
+#include "../../include/FdTable.hpp"
+
+#define LOAD_CONNECT_WINDOW	256		// Connections being set up at once
+#define LOAD_READ_SIZE		16384
+#define LOAD_DRAIN_US		2000000	// Wait for late deliveries after the run
+
+#define HIST_SUB_BITS		5		// 32 buckets per power of two, ~3% error
+#define HIST_LINEAR			64		// Values below are counted exactly
+#define HIST_BUCKETS		(HIST_LINEAR + (64 - 6) * (1 << HIST_SUB_BITS))
+
+// Command line of ircbench
+struct LoadConfig
+{
+	std::string host;
+	int port;
+	std::string password;
+	size_t clients;
+	size_t channels;
+	bool zipf;				// Channel sizes: zipf (1/rank) or uniform
+	size_t rate;			// Channel messages per second, all senders
+	size_t duration;		// Seconds of message load
+	size_t notice_percent;	// Share of NOTICE among the messages
+	size_t setup_timeout;	// Seconds allowed for connecting and joining
+
+	LoadConfig();
+};
+
+// Log-linear histogram of microsecond values
+class Histogram
+{
+	private:
+		std::vector<unsigned long> _buckets;
+		unsigned long _count;
+		unsigned long _max;
+
+		static size_t _bucketOf(unsigned long value);
+		static unsigned long _lowerBound(size_t bucket);
+
+	public:
+		Histogram();
+
+		void record(unsigned long value);
+		unsigned long percentile(double fraction) const;
+		unsigned long count() const;
+		unsigned long max() const;
+};
+
+enum LoadState
+{
+	LOAD_CONNECTING,
+	LOAD_REGISTERING,
+	LOAD_JOINING,
+	LOAD_READY,
+	LOAD_CLOSED
+};
+
+// One simulated user
+struct LoadClient
+{
+	int fd;
+	LoadState state;
+	size_t channel;
+	size_t ready_slot;			// Position in LoadRun::_ready once joined
+	unsigned long started_us;	// connect() call
+	std::string input;			// Bytes not yet split into lines
+	std::string output;			// Bytes the socket did not take yet
+
+	LoadClient();
+};
+
+// Drives every simulated client from one event loop
+class LoadRun
+{
+	private:
+		LoadConfig const &_config;
+		Reactor *_reactor;
+		std::vector<LoadClient> _clients;
+		FdTable<size_t> _by_fd;				// Socket -> index in _clients
+		std::vector<size_t> _ready;			// Joined clients still connected, the senders
+		std::vector<size_t> _members;		// Joined clients per channel
+		std::vector<double> _weights;		// Cumulative channel size shares
+		std::vector<ReactorEvent> _events;
+		size_t _next_connect;
+		size_t _connecting;
+
+		void _startConnections(void);
+		void _connected(LoadClient &client);
+		void _close(LoadClient &client);
+		void _queue(LoadClient &client, std::string const &line);
+		void _flush(LoadClient &client);
+		void _read(LoadClient &client);
+		void _handleLine(LoadClient &client, std::string const &line);
+		void _poll(int timeout_ms);
+		void _sendMessage(void);
+		size_t _pickChannel(void) const;
+
+		LoadRun(LoadRun const &other);
+		LoadRun &operator=(LoadRun const &other);
+
+	public:
+		// Results, read by the report
+		Histogram setup_latency;		// connect() to RPL_WELCOME
+		Histogram delivery_latency;		// PRIVMSG sent to PRIVMSG received
+		unsigned long setup_us;			// Until the last client registered
+		unsigned long join_us;			// Until the last client joined
+		size_t registered;
+		size_t failed;					// Refused, reset or timed out
+		size_t dropped;					// Disconnected after joining
+		unsigned long sent;
+		unsigned long expected;			// Deliveries the sends should cause
+		unsigned long delivered;
+		unsigned long load_us;			// Length of the message phase
+
+		LoadRun(LoadConfig const &config);
+		~LoadRun();
+
+		bool setup(void);
+		bool load(void);
+};
+
+unsigned long loadClockUs(void);
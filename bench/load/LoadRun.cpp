@@ -0,0 +1,373 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LoadRun.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 22:10:52 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 22:10:52 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "IrcBench.hpp"
+#include "../../include/Utils.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define LOAD_TAG	"lb "	// Start of every load message text
+
+unsigned long loadClockUs(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<unsigned long>(now.tv_sec) * 1000000UL \
+		+ now.tv_nsec / 1000;
+}
+
+LoadConfig::LoadConfig() : host("127.0.0.1"), port(0), clients(1000), \
+	channels(10), zipf(false), rate(1000), duration(10), notice_percent(0), \
+	setup_timeout(30)
+{
+}
+
+LoadClient::LoadClient() : fd(-1), state(LOAD_CLOSED), channel(0), \
+	ready_slot(0), started_us(0)
+{
+}
+
+LoadRun::LoadRun(LoadConfig const &config) : _config(config), \
+	_reactor(Reactor::create()), _clients(config.clients), \
+	_members(config.channels, 0), _next_connect(0), _connecting(0), \
+	setup_us(0), join_us(0), registered(0), failed(0), dropped(0), sent(0), \
+	expected(0), delivered(0), load_us(0)
+{
+	// Share of the joins each channel gets, as a running sum
+	double total = 0;
+	for (size_t i = 0; i < config.channels; i++)
+	{
+		total += config.zipf ? 1.0 / (i + 1) : 1.0;
+		this->_weights.push_back(total);
+	}
+	for (size_t i = 0; i < this->_weights.size(); i++)
+		this->_weights[i] /= total;
+}
+
+LoadRun::~LoadRun()
+{
+	for (size_t i = 0; i < this->_clients.size(); i++)
+	{
+		if (this->_clients[i].fd >= 0)
+			close(this->_clients[i].fd);
+	}
+	delete this->_reactor;
+}
+
+size_t LoadRun::_pickChannel(void) const
+{
+	double draw = static_cast<double>(rand()) / RAND_MAX;
+	for (size_t i = 0; i < this->_weights.size(); i++)
+	{
+		if (draw <= this->_weights[i])
+			return i;
+	}
+	return this->_weights.size() - 1;
+}
+
+// Keeps LOAD_CONNECT_WINDOW registrations in flight, so the server's accept
+// queue is stressed without SYNs being dropped on the floor
+void LoadRun::_startConnections(void)
+{
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(this->_config.port);
+	inet_pton(AF_INET, this->_config.host.c_str(), &addr.sin_addr);
+
+	while (this->_connecting < LOAD_CONNECT_WINDOW \
+		&& this->_next_connect < this->_clients.size())
+	{
+		LoadClient &client = this->_clients[this->_next_connect];
+		size_t index = this->_next_connect++;
+
+		client.fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (client.fd == -1)
+		{
+			this->failed++;
+			continue;
+		}
+		fcntl(client.fd, F_SETFL, O_NONBLOCK);
+		int nodelay = 1;
+		setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, \
+			sizeof(nodelay));
+
+		client.started_us = loadClockUs();
+		client.channel = this->_pickChannel();
+		if (connect(client.fd, reinterpret_cast<sockaddr *>(&addr), \
+			sizeof(addr)) == -1 && errno != EINPROGRESS)
+		{
+			this->_close(client);
+			continue;
+		}
+		client.state = LOAD_CONNECTING;
+		this->_by_fd.insert(client.fd, index);
+		this->_reactor->add(client.fd, IO_WRITE);
+		this->_connecting++;
+	}
+}
+
+void LoadRun::_connected(LoadClient &client)
+{
+	int error = 0;
+	socklen_t length = sizeof(error);
+
+	if (getsockopt(client.fd, SOL_SOCKET, SO_ERROR, &error, &length) == -1 \
+		|| error != 0)
+	{
+		this->_close(client);
+		return;
+	}
+
+	std::string nick = "lb" + itoa(static_cast<int>(&client - &this->_clients[0]));
+	client.state = LOAD_REGISTERING;
+	this->_reactor->modify(client.fd, IO_READ);
+	this->_queue(client, "PASS " + this->_config.password + "\r\nNICK " + nick \
+		+ "\r\nUSER " + nick + " 0 * :" + nick + "\r\n");
+}
+
+void LoadRun::_close(LoadClient &client)
+{
+	if (client.state == LOAD_CONNECTING || client.state == LOAD_REGISTERING)
+		this->_connecting--;
+	if (client.state == LOAD_READY)
+	{
+		// Swap out of the senders so every pick is a live client
+		size_t last = this->_ready.back();
+		this->_ready[client.ready_slot] = last;
+		this->_clients[last].ready_slot = client.ready_slot;
+		this->_ready.pop_back();
+		this->dropped++;
+		this->_members[client.channel]--;
+	}
+	else
+		this->failed++;
+	if (client.fd >= 0)
+	{
+		this->_reactor->remove(client.fd);
+		this->_by_fd.erase(client.fd);
+		close(client.fd);
+	}
+	client.fd = -1;
+	client.state = LOAD_CLOSED;
+}
+
+void LoadRun::_queue(LoadClient &client, std::string const &line)
+{
+	if (client.fd < 0)
+		return;
+	bool idle = client.output.empty();
+	client.output += line;
+	if (idle)
+		this->_flush(client);
+}
+
+// Whatever the socket does not take waits for IO_WRITE
+void LoadRun::_flush(LoadClient &client)
+{
+	while (!client.output.empty())
+	{
+		ssize_t written = send(client.fd, client.output.data(), \
+			client.output.size(), MSG_NOSIGNAL);
+		if (written < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			if (errno == EINTR)
+				continue;
+			this->_close(client);
+			return;
+		}
+		client.output.erase(0, written);
+	}
+	this->_reactor->modify(client.fd, \
+		client.output.empty() ? IO_READ : IO_READ | IO_WRITE);
+}
+
+void LoadRun::_read(LoadClient &client)
+{
+	char buffer[LOAD_READ_SIZE];
+
+	ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+	if (received < 0 && (errno == EAGAIN || errno == EINTR))
+		return;
+	if (received <= 0)
+	{
+		this->_close(client);
+		return;
+	}
+	client.input.append(buffer, received);
+
+	size_t start = 0;
+	size_t end;
+	while (client.fd >= 0 \
+		&& (end = client.input.find('\n', start)) != std::string::npos)
+	{
+		size_t length = end - start;
+		if (length > 0 && client.input[end - 1] == '\r')
+			length--;
+		this->_handleLine(client, client.input.substr(start, length));
+		start = end + 1;
+	}
+	client.input.erase(0, start);
+}
+
+void LoadRun::_handleLine(LoadClient &client, std::string const &line)
+{
+	if (line.compare(0, 5, "PING ") == 0)
+	{
+		this->_queue(client, "PONG " + line.substr(5) + "\r\n");
+		return;
+	}
+
+	// ":source COMMAND params"
+	size_t command = line.find(' ');
+	if (line.empty() || line[0] != ':' || command == std::string::npos)
+		return;
+	command++;
+	unsigned long now = loadClockUs();
+
+	if (line.compare(command, 4, "001 ") == 0 \
+		&& client.state == LOAD_REGISTERING)
+	{
+		this->setup_latency.record(now - client.started_us);
+		this->registered++;
+		this->setup_us = now;
+		client.state = LOAD_JOINING;
+		this->_connecting--;
+		this->_queue(client, "JOIN #load" + itoa(client.channel) + "\r\n");
+	}
+	else if (line.compare(command, 4, "366 ") == 0 \
+		&& client.state == LOAD_JOINING)
+	{
+		client.state = LOAD_READY;
+		this->join_us = now;
+		this->_members[client.channel]++;
+		client.ready_slot = this->_ready.size();
+		this->_ready.push_back(&client - &this->_clients[0]);
+	}
+	else if (line.compare(command, 8, "PRIVMSG ") == 0 \
+		|| line.compare(command, 7, "NOTICE ") == 0)
+	{
+		size_t text = line.find(" :" LOAD_TAG, command);
+		if (text == std::string::npos)
+			return;
+		unsigned long sent_us = strtoul(line.c_str() + text + 2 \
+			+ sizeof(LOAD_TAG) - 1, NULL, 10);
+		this->delivery_latency.record(now > sent_us ? now - sent_us : 0);
+		this->delivered++;
+	}
+}
+
+void LoadRun::_poll(int timeout_ms)
+{
+	if (this->_reactor->wait(this->_events, timeout_ms) <= 0)
+		return;
+
+	for (size_t i = 0; i < this->_events.size(); i++)
+	{
+		size_t *index = this->_by_fd.find(this->_events[i].fd);
+		if (!index)
+			continue;
+		LoadClient &client = this->_clients[*index];
+		int events = this->_events[i].events;
+
+		if (client.state == LOAD_CONNECTING)
+		{
+			this->_connected(client);
+			continue;
+		}
+		if (events & (IO_READ | IO_HANGUP))
+			this->_read(client);
+		if (client.fd >= 0 && (events & IO_WRITE))
+			this->_flush(client);
+	}
+}
+
+// Connects, registers and joins every client; false if none made it
+bool LoadRun::setup(void)
+{
+	unsigned long start = loadClockUs();
+	unsigned long deadline = start + this->_config.setup_timeout * 1000000UL;
+
+	srand(42);
+	while (this->_ready.size() + this->failed < this->_clients.size() \
+		&& loadClockUs() < deadline)
+	{
+		this->_startConnections();
+		this->_poll(10);
+	}
+	this->setup_us = this->setup_us > start ? this->setup_us - start : 0;
+	this->join_us = this->join_us > start ? this->join_us - start : 0;
+
+	// Whoever is still on its way counts as failed
+	for (size_t i = 0; i < this->_clients.size(); i++)
+	{
+		if (this->_clients[i].state != LOAD_READY \
+			&& this->_clients[i].state != LOAD_CLOSED)
+			this->_close(this->_clients[i]);
+	}
+	return !this->_ready.empty();
+}
+
+// A random joined client talks to its channel, the line carries the time
+void LoadRun::_sendMessage(void)
+{
+	LoadClient &client = this->_clients[this->_ready[rand() \
+		% this->_ready.size()]];
+
+	bool notice = static_cast<size_t>(rand() % 100) \
+		< this->_config.notice_percent;
+	char stamp[32];
+	snprintf(stamp, sizeof(stamp), "%lu", loadClockUs());
+	this->_queue(client, std::string(notice ? "NOTICE" : "PRIVMSG") \
+		+ " #load" + itoa(client.channel) + " :" LOAD_TAG + stamp + "\r\n");
+	this->sent++;
+	this->expected += this->_members[client.channel] - 1;
+}
+
+// False when the server dropped every sender before the end
+bool LoadRun::load(void)
+{
+	unsigned long start = loadClockUs();
+	unsigned long end = start + this->_config.duration * 1000000UL;
+	unsigned long now = start;
+
+	// Stops early once the server dropped every sender
+	while (now < end && !this->_ready.empty())
+	{
+		// Messages owed at the configured rate since the start
+		unsigned long due = (now - start) * this->_config.rate / 1000000UL;
+		while (this->sent < due && !this->_ready.empty())
+			this->_sendMessage();
+		this->_poll(1);
+		now = loadClockUs();
+	}
+	this->load_us = now - start;
+	bool completed = !this->_ready.empty();
+
+	// Late lines still count, for a bounded time
+	unsigned long drain_end = now + LOAD_DRAIN_US;
+	while (this->delivered < this->expected && loadClockUs() < drain_end)
+		this->_poll(10);
+	return completed;
+}
@@ -19,6 +19,8 @@
 #include <set>
 #include <algorithm>
 
+#include "ObjectPool.hpp"
+
 class Server;
 class Client;
 
@@ -31,6 +33,23 @@ class Client;
 #define MODE_NO_EXTERNAL_MSGS 'n'
 #define MODE_SECRET 's'
 #define MODE_PRIVATE 'p'
+#define MODE_LETTERS "iklmnpst" // Every mode above, in RPL_CHANNELMODEIS order
+
+// Per member status bits
+#define MEMBER_OP		0x01
+#define MEMBER_VOICE	0x02
+
+// Client id sets, their tree nodes come from a pool
+typedef std::set<unsigned long, std::less<unsigned long>, \
+	PoolAllocator<unsigned long> > IdSet;
+
+// One row of the member table, fanout walks these contiguously
+struct ChannelMember
+{
+	Client *client;
+	unsigned int flags;
+	size_t names_chunk; //Channel::_names chunk holding this member's entry
+};
 
 class Channel
 {
@@ -41,29 +60,47 @@ class Channel
 		std::string _password;
 		std::string _key;  //for +k mode
 		
-		std::set<std::string> _userlist;
-		std::set<std::string> _operators;
-		std::set<std::string> _banned;
-		std::set<std::string> _invited; //invited list mode +i
-
-		std::set<char> _modes; //channel active modes
+		std::vector<ChannelMember> _members; //Swap-removed, see removeUser()
+		std::vector<std::string> _names; //NAMES payload in chunks, see getNames()
+		size_t _names_budget;            //Chunk size _names holds, 0 when stale
+		size_t _names_bytes;             //Entries plus separators in _names
+		IdSet _banned;     //Client ids
+		IdSet _invited;    //Client ids, invited list mode +i
+
+		unsigned int _modes;     //Active modes, one bit per MODE_LETTERS entry
+		std::string _mode_string; //RPL_CHANNELMODEIS text, rebuilt by setMode()
 		size_t _user_limit;    // user limits mode +l
 
 		time_t _creation_time;
 
 		bool _hasMode(char mode) const;
-		void _broadcastToChannel(Server *server, const std::string &message, int exclude_fd = -1);
-		std::string _getUserModePrefix(const std::string &nickname) const;
+		static unsigned int _modeBit(char mode);
+		void _updateModeString();
+		void _broadcastToChannel(Server *server, SharedMessage const &message, Client *exclude = NULL);
+		std::string _getUserModePrefix(unsigned int flags) const;
+		std::string _nameEntry(ChannelMember const &member) const;
+		void _appendName(ChannelMember &member);
+		void _removeName(ChannelMember const &member, std::string const &entry);
+		void _updateName(ChannelMember &member, std::string const &old_entry);
+		void _compactNames();
+		void _rebuildNames();
+		ChannelMember *_findMember(Client const *client);
+		ChannelMember const *_findMember(Client const *client) const;
 
 	public:
 		Channel(std::string const &name, std::string const &password = "");
 		~Channel();
 
+		//Storage comes from a free list pool instead of the heap
+		static void *operator new(size_t size);
+		static void operator delete(void *pointer);
+		static ObjectPool<Channel> &pool();
+
 		//Getters
-		std::string getName() const;
-		std::string getTopic() const;
-		std::string getPassword() const;
-		std::string getKey() const;
+		std::string const &getName() const;
+		std::string const &getTopic() const;
+		std::string const &getPassword() const;
+		std::string const &getKey() const;
 		size_t getUserCount() const;
 		size_t getUserLimit() const;
 		time_t getCreationTime() const;
@@ -74,35 +111,36 @@ class Channel
 		
 		
 		//User management
-		bool addUser(std::string const &user, std::string const &password = "");
-		bool removeUser(std::string const &user);
-		bool hasUser(std::string const &user) const;
-		std::vector<std::string> getUserList() const;
-		std::string getUserListString() const;
-		bool updateUserNick(const std::string &oldNick, const std::string &newNick);
+		bool addUser(Client *client, std::string const &password = "");
+		bool removeUser(Client *client);
+		bool hasUser(Client const *client) const;
+		std::vector<ChannelMember> const &getMembers() const;
+		std::vector<std::string> const &getNames(size_t budget);
+		void renameUser(Client *client, std::string const &old_nick);
 
 		//Operators management
-		bool addOp(std::string const &user);
-		bool removeOp(std::string const &user);
-		bool isOp(std::string const &user) const;
+		bool addOp(Client *client);
+		bool removeOp(Client *client);
+		bool isOp(Client const *client) const;
 		
 		//Invite system
-		bool inviteUser(std::string const &user);
-		bool isInvited (std::string const &user) const;
+		bool inviteUser(Client const *client);
+		bool isInvited (Client const *client) const;
 		
 		//Modes management
 		bool setMode(char mode, bool enable, std::string const &param = "");
 		bool hasMode (char mode) const;
-		std::string getModeString() const;
+		std::string const &getModeString() const;
 
 		//Validations
 		bool isPasswordRequired() const;
-		bool canUserJoin(std::string const &user, std::string const &password = "") const;
-		bool canUserSetTopic(std::string const &user) const;
+		bool canUserJoin(Client const *client, std::string const &password = "") const;
+		bool canUserSetTopic(Client const *client) const;
 
 		//Connection and Communication
 		bool connect(Server *server, int client_fd);
-		void sendMessage(Server *server, const std::string &sender, std::string const msg, std::string command);
+		void sendNames(Server *server, Client *client);
+		void sendMessage(Server *server, Client *sender, std::string const &msg, std::string const &command);
 
 		//System messages
 		void announceJoin(Server *server, Client *client);
@@ -22,14 +22,33 @@
 #include <vector>
 #include <set>
 #include <ctime>
+#include <cerrno>
+#include <sys/uio.h>
 
 #include "Utils.hpp"
+#include "SharedMessage.hpp"
+#include "LineBuffer.hpp"
+#include "TimerWheel.hpp"
+#include "ObjectPool.hpp"
+#include "RingQueue.hpp"
 
-#define MAX_BUFFER_SIZE 4096
+#define FLUSH_IOV_MAX 64 //Queued lines handed to one writev()
+
+class Channel;
+struct Shard;
+
+// Reverse membership entry: where this client sits in a channel's table
+struct ChannelLink
+{
+	Channel *channel;
+	size_t slot;
+};
 
 class Client
 {
 	private:
+		unsigned long _id; //Never reused, safe to keep after the client is gone
+		Shard *_shard;     //Event loop owning the socket and the queues
 		int _client_fd;
 		sockaddr_in _client_addr;
 		std::string _nickname;
@@ -37,26 +56,46 @@ class Client
 		std::string _realname;
 		std::string _hostname;
 		std::string _password;
-		std::string _buffer;
-		std::set<std::string> _channels; //Channels in which the client is participating
-		time_t _lastActivity;
+		std::string _prefix; //":nick!user@host", rebuilt when one of them changes
+		LineBuffer _input; //Received bytes not yet split into lines
+		RingQueue<SharedMessage> _sendq; //Outbound lines waiting for the socket
+		size_t _sendq_offset;            //Bytes of _sendq.front() already sent
+		size_t _sendq_bytes;             //Bytes still waiting in _sendq
+		std::string _quit_reason;        //Set when the server must drop the client
+		int _watched_events;             //IO_* interest registered in the reactor
+		bool _flush_scheduled;           //Queued for the end of loop flush
+		bool _closing;                   //Last reply queued, input is discarded
+		std::vector<ChannelLink> _channels; //Channels in which the client is participating
+		unsigned long _lastActivity; //Monotonic time of the last command
+		TimerNode _timer;             //Registration or keepalive deadline
+		unsigned long _ping_sent_ms;  //Monotonic time of the unanswered PING, 0 if none
 		bool _isRegistered;
 		bool _hasPassword;
 		bool _hasNick;
 		bool _hasUser;
 
+		void _updatePrefix();
+
 	public:
 		Client(int client_socket, sockaddr_in client_addr);
 		~Client();
+
+		//Storage comes from a free list pool instead of the heap
+		static void *operator new(size_t size);
+		static void operator delete(void *pointer);
+		static ObjectPool<Client> &pool();
 		
 		//Getters
+		unsigned long getId() const;
+		Shard *getShard() const;
+		void setShard(Shard *shard);
 		int getFd() const;
-		std::string getNickname() const;
-		std::string getUsername() const;
-		std::string getRealname() const;
-		std::string getHostname() const;
-		std::string getPassword() const;
-		std::string getBuffer() const;
+		std::string const &getNickname() const;
+		std::string const &getUsername() const;
+		std::string const &getRealname() const;
+		std::string const &getHostname() const;
+		std::string const &getPassword() const;
+		std::string const &getPrefix() const;
 		sockaddr_in getClientAddr() const;
 		bool isRegistered() const;
 		
@@ -66,20 +105,38 @@ class Client
 		void setRealname(const std::string &realname);
 		
 		//Buffer Management
-		void appendBuffer(const std::string &data);
-		bool isDataComplete() const;
+		size_t getBufferSpace() const;
+		void appendBuffer(const char *data, size_t length);
 		void cleanBuffer();
-		std::string getNextCompleteMessage();
+		bool getNextCompleteMessage(LineView &line);
+
+		//Outbound queue
+		void queueMessage(SharedMessage const &message);
+		bool hasPendingOutput() const;
+		size_t getSendQBytes() const;
+		int flushSendQueue(unsigned long &syscalls);
+		bool isFlushScheduled() const;
+		void setFlushScheduled(bool scheduled);
+		int getWatchedEvents() const;
+		void setWatchedEvents(int events);
+
+		//Deferred disconnection
+		void setClosing(bool closing);
+		bool isClosing() const;
+		void setQuitReason(const std::string &reason);
+		std::string const &getQuitReason() const;
+		bool hasQuitReason() const;
 
 		//Registration process
 		void setNamesAndPass(const std::string &data);
 		void checkRegistrationComplete();
 
-		//Channel Management
-		void joinChannel(const std::string &channelName);
-		void leaveChannel(const std::string &channelName);
-		bool isInChannel(const std::string &channelName) const;
-		std::set<std::string> getChannels() const;
+		//Channel Management, kept in sync by Channel
+		void linkChannel(Channel *channel, size_t slot);
+		void unlinkChannel(Channel *channel);
+		void relinkChannel(Channel *channel, size_t slot);
+		int getChannelSlot(Channel const *channel) const;
+		std::vector<ChannelLink> const &getChannels() const;
 		
 		// Validation
 		bool isValidInput(const std::string &input) const;
@@ -90,6 +147,11 @@ class Client
 		void parseUserCommand(const std::string &line);
 
 		//Activity check
-		void setLastActivity (time_t now);
-		time_t getLastActivity (void);
+		void setLastActivity (unsigned long now_ms);
+		unsigned long getLastActivity (void) const;
+
+		//Keepalive
+		TimerNode &getTimer();
+		void setPingSent(unsigned long now_ms);
+		unsigned long getPingSent() const;
 };
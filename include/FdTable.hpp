@@ -0,0 +1,101 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FdTable.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 12:31:40 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 12:31:40 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Dense table of values keyed by file descriptor.
+// Values are packed in _dense (so they can be walked or handed to poll()
+// as one array) and _slots maps each fd back to its packed index.
+// Insert, erase (swap with the last entry) and lookup are O(1).
+template <typename T>
+class FdTable
+{
+	private:
+		std::vector<T> _dense;
+		std::vector<int> _dense_fds;	// fd owning each packed entry
+		std::vector<int> _slots;		// fd -> packed index, -1 when free
+
+	public:
+		FdTable() {}
+		~FdTable() {}
+
+		bool insert(int fd, T const &value)
+		{
+			if (fd < 0)
+				return false;
+			if (static_cast<size_t>(fd) >= this->_slots.size())
+				this->_slots.resize(fd + 1, -1);
+			if (this->_slots[fd] != -1)
+				return false;
+			this->_slots[fd] = static_cast<int>(this->_dense.size());
+			this->_dense.push_back(value);
+			this->_dense_fds.push_back(fd);
+			return true;
+		}
+
+		bool erase(int fd)
+		{
+			int index = this->indexOf(fd);
+			if (index == -1)
+				return false;
+
+			// Move the last entry into the hole and fix its back index
+			int last = static_cast<int>(this->_dense.size()) - 1;
+			if (index != last)
+			{
+				this->_dense[index] = this->_dense[last];
+				this->_dense_fds[index] = this->_dense_fds[last];
+				this->_slots[this->_dense_fds[index]] = index;
+			}
+			this->_dense.pop_back();
+			this->_dense_fds.pop_back();
+			this->_slots[fd] = -1;
+			return true;
+		}
+
+		int indexOf(int fd) const
+		{
+			if (fd < 0 || static_cast<size_t>(fd) >= this->_slots.size())
+				return -1;
+			return this->_slots[fd];
+		}
+
+		T *find(int fd)
+		{
+			int index = this->indexOf(fd);
+			return (index == -1) ? NULL : &this->_dense[index];
+		}
+
+		bool contains(int fd) const
+		{
+			return (this->indexOf(fd) != -1);
+		}
+
+		// Packed access, valid for index < size()
+		T &at(size_t index) { return this->_dense[index]; }
+		T const &at(size_t index) const { return this->_dense[index]; }
+		int fdAt(size_t index) const { return this->_dense_fds[index]; }
+		T *data() { return this->_dense.empty() ? NULL : &this->_dense[0]; }
+
+		size_t size() const { return this->_dense.size(); }
+		bool empty() const { return this->_dense.empty(); }
+
+		void clear()
+		{
+			this->_dense.clear();
+			this->_dense_fds.clear();
+			this->_slots.clear();
+		}
+};
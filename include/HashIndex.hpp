@@ -0,0 +1,165 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HashIndex.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 13:05:12 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 13:05:12 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Case sensitive keys (nicknames)
+struct ExactKey
+{
+	static size_t hash(std::string const &key)
+	{
+		// FNV-1a
+		size_t h = 2166136261u;
+		for (size_t i = 0; i < key.length(); i++)
+		{
+			h ^= static_cast<unsigned char>(key[i]);
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	static bool equal(std::string const &a, std::string const &b)
+	{
+		return a == b;
+	}
+};
+
+// RFC 1459 case mapping (channel names): A-Z and []\^ fold to a-z and {}|~
+struct IrcCaseKey
+{
+	static unsigned char fold(unsigned char c)
+	{
+		if (c >= 'A' && c <= '^')
+			return c + ('a' - 'A');
+		return c;
+	}
+
+	static size_t hash(std::string const &key)
+	{
+		size_t h = 2166136261u;
+		for (size_t i = 0; i < key.length(); i++)
+		{
+			h ^= fold(static_cast<unsigned char>(key[i]));
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	static bool equal(std::string const &a, std::string const &b)
+	{
+		if (a.length() != b.length())
+			return false;
+		for (size_t i = 0; i < a.length(); i++)
+			if (fold(static_cast<unsigned char>(a[i])) \
+				!= fold(static_cast<unsigned char>(b[i])))
+				return false;
+		return true;
+	}
+};
+
+// String keyed hash table with separate chaining (C++98 has no
+// unordered_map). KeyPolicy provides hash() and equal(), which lets
+// callers pick exact or case-folded key matching.
+template <typename T, typename KeyPolicy = ExactKey>
+class HashIndex
+{
+	private:
+		struct Entry
+		{
+			std::string key;
+			T value;
+		};
+
+		std::vector<std::vector<Entry> > _buckets;
+		size_t _size;
+
+		std::vector<Entry> &_bucketFor(std::string const &key)
+		{
+			return this->_buckets[KeyPolicy::hash(key) & (this->_buckets.size() - 1)];
+		}
+
+		void _rehash(size_t bucket_count)
+		{
+			std::vector<std::vector<Entry> > old;
+			old.swap(this->_buckets);
+			this->_buckets.resize(bucket_count);
+			for (size_t i = 0; i < old.size(); i++)
+				for (size_t j = 0; j < old[i].size(); j++)
+					this->_bucketFor(old[i][j].key).push_back(old[i][j]);
+		}
+
+	public:
+		HashIndex() : _buckets(16), _size(0) {}
+		~HashIndex() {}
+
+		T *find(std::string const &key)
+		{
+			std::vector<Entry> &bucket = this->_bucketFor(key);
+			for (size_t i = 0; i < bucket.size(); i++)
+				if (KeyPolicy::equal(bucket[i].key, key))
+					return &bucket[i].value;
+			return NULL;
+		}
+
+		// Returns false (and keeps the old value) if key is already there
+		bool insert(std::string const &key, T const &value)
+		{
+			if (this->find(key))
+				return false;
+			if (this->_size + 1 > this->_buckets.size())
+				this->_rehash(this->_buckets.size() * 2);
+
+			Entry entry;
+			entry.key = key;
+			entry.value = value;
+			this->_bucketFor(key).push_back(entry);
+			this->_size++;
+			return true;
+		}
+
+		bool erase(std::string const &key)
+		{
+			std::vector<Entry> &bucket = this->_bucketFor(key);
+			for (size_t i = 0; i < bucket.size(); i++)
+			{
+				if (KeyPolicy::equal(bucket[i].key, key))
+				{
+					bucket[i] = bucket.back();
+					bucket.pop_back();
+					this->_size--;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Copies every value out, for teardown and full walks
+		void values(std::vector<T> &out) const
+		{
+			for (size_t i = 0; i < this->_buckets.size(); i++)
+				for (size_t j = 0; j < this->_buckets[i].size(); j++)
+					out.push_back(this->_buckets[i][j].value);
+		}
+
+		size_t size() const { return this->_size; }
+		bool empty() const { return this->_size == 0; }
+
+		void clear()
+		{
+			std::vector<std::vector<Entry> >(16).swap(this->_buckets);
+			this->_size = 0;
+		}
+};
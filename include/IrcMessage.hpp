@@ -0,0 +1,60 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IrcMessage.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 15:48:03 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 15:48:03 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstring>
+
+#define IRC_MAX_PARAMS 15 //RFC 1459 limit, the last one takes the rest
+
+// Slice of the line being processed, nothing is copied
+struct IrcToken
+{
+	const char *data;
+	size_t length;
+
+	bool empty() const { return this->length == 0; }
+	std::string str() const { return std::string(this->data, this->length); }
+	bool equals(const char *text) const
+	{
+		return (strlen(text) == this->length \
+			&& memcmp(this->data, text, this->length) == 0);
+	}
+};
+
+// One RFC 1459 line split once into [:prefix] command params [:trailing].
+// Tokens point into the parsed line, which must outlive the message.
+class IrcMessage
+{
+	private:
+		IrcToken _prefix;
+		IrcToken _command;
+		IrcToken _params[IRC_MAX_PARAMS];
+		size_t _param_count;
+		bool _has_trailing; //Last parameter was given after ':'
+
+	public:
+		IrcMessage();
+		IrcMessage(const char *line, size_t length);
+		~IrcMessage();
+
+		bool parse(const char *line, size_t length);
+
+		IrcToken const &getPrefix() const;
+		IrcToken const &getCommand() const;
+		size_t paramCount() const;
+		bool hasTrailing() const;
+		IrcToken const &param(size_t index) const;
+		std::string getParam(size_t index, std::string const &fallback = "") const;
+};
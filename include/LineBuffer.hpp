@@ -0,0 +1,51 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LineBuffer.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 15:02:37 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 15:02:37 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#define LINE_BUFFER_SIZE 4096 //Must be a power of two
+
+// Complete input line, without its "\r\n" / "\n" terminator.
+// Points into the LineBuffer and is valid until the next append().
+struct LineView
+{
+	const char *data;
+	size_t length;
+};
+
+// Fixed capacity ring buffer assembling input lines.
+// Bytes are never shifted: consuming a line only moves _head, and the
+// already scanned part of a partial line is not searched again when more
+// data arrives. A line crossing the end of the ring is the only copy made.
+class LineBuffer
+{
+	private:
+		char _data[LINE_BUFFER_SIZE];
+		char _wrapped[LINE_BUFFER_SIZE]; //Linear copy of a line that wraps
+		size_t _head;    //Index of the first unread byte
+		size_t _size;    //Unread bytes
+		size_t _scanned; //Unread bytes known to hold no '\n'
+
+	public:
+		LineBuffer();
+		~LineBuffer();
+
+		bool append(const char *data, size_t length);
+		bool nextLine(LineView &line);
+		void clear();
+
+		size_t size() const;
+		size_t space() const;
+};
@@ -0,0 +1,48 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Log.hpp                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 18:05:12 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 18:05:12 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Log levels (type argument of logMessage), lowest first
+#define DBG		0	// Per line tracing, see LOG_DEBUG
+#define LOG		1	// Normal events, stdout
+#define WARN	2	// Handled trouble (sendq, overflows...), stdout
+#define ERR		3	// Failures, stderr
+
+#define LOG_RING_SLOTS	1024	// Power of two
+#define LOG_LINE_MAX	512		// Longer lines are truncated
+
+// Debug logging costs nothing unless built with make DEBUG_LOG=1: the
+// arguments are not even evaluated, so call sites can build strings freely
+#ifdef IRC_DEBUG_LOG
+# define LOG_DEBUG(msg, msg_color, args, args_color) \
+	logMessage(msg, msg_color, args, args_color, DBG)
+#else
+# define LOG_DEBUG(msg, msg_color, args, args_color) \
+	do { } while (0)
+#endif
+
+// Lines go into a fixed lock-free ring and a background thread writes them,
+// so a slow terminal or log pipe never blocks an event loop. When the ring
+// is full the line is dropped and counted instead.
+// Before logStart() and after logStop() lines are written directly.
+void logMessage(std::string const &msg, std::string const &msg_color, \
+	std::string const &args, std::string const &args_color, int type = LOG);
+
+bool logStart(void);
+void logStop(void);
+void logSetLevel(int level);
+bool logParseLevel(std::string const &name, int &level);
+unsigned long logDropped(void);
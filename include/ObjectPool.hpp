@@ -0,0 +1,188 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ObjectPool.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 19:48:21 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 19:48:21 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <vector>
+#include <new>
+#include <limits>
+#include <cstddef>
+#include <pthread.h>
+
+#include "ScopedLock.hpp"
+
+#define POOL_SLAB_MIN	32	// Objects per slab when the pool has to grow
+
+// Fixed size blocks for objects of type T, carved out of slabs and recycled
+// through a free list, so churn never reaches the general allocator.
+// Slabs are only given back when the pool itself goes away.
+// Locked, since clients are created by every shard thread.
+template <typename T>
+class ObjectPool
+{
+	private:
+		// A free block stores the link to the next one in its own bytes
+		union Block
+		{
+			Block *next;
+			char storage[sizeof(T)];
+			double align_double;	// Strictest alignments a T may need
+			long align_long;
+			void *align_pointer;
+		};
+
+		std::vector<Block*> _slabs;
+		Block *_free;
+		size_t _capacity;
+		size_t _in_use;
+		pthread_mutex_t _lock;
+
+		void _grow(size_t count)
+		{
+			Block *slab = static_cast<Block *>(::operator new(count * sizeof(Block)));
+			this->_slabs.push_back(slab);
+			for (size_t i = 0; i < count; i++)
+			{
+				slab[i].next = this->_free;
+				this->_free = &slab[i];
+			}
+			this->_capacity += count;
+		}
+
+		ObjectPool(ObjectPool const &other);
+		ObjectPool &operator=(ObjectPool const &other);
+
+	public:
+		ObjectPool() : _free(NULL), _capacity(0), _in_use(0)
+		{
+			pthread_mutex_init(&this->_lock, NULL);
+		}
+
+		~ObjectPool()
+		{
+			for (size_t i = 0; i < this->_slabs.size(); i++)
+				::operator delete(this->_slabs[i]);
+			pthread_mutex_destroy(&this->_lock);
+		}
+
+		// Shared pool of this block size, used by PoolAllocator
+		static ObjectPool &shared()
+		{
+			static ObjectPool pool;
+			return pool;
+		}
+
+		// Preallocation, so the first connections don't pay for the slabs
+		void reserve(size_t count)
+		{
+			ScopedLock lock(this->_lock);
+			if (count > this->_capacity)
+				this->_grow(count - this->_capacity);
+		}
+
+		void *allocate()
+		{
+			ScopedLock lock(this->_lock);
+			if (!this->_free)
+				this->_grow(this->_capacity > POOL_SLAB_MIN \
+					? this->_capacity / 2 : POOL_SLAB_MIN);
+			Block *block = this->_free;
+			this->_free = block->next;
+			this->_in_use++;
+			return block;
+		}
+
+		void release(void *pointer)
+		{
+			if (!pointer)
+				return;
+			ScopedLock lock(this->_lock);
+			Block *block = static_cast<Block *>(pointer);
+			block->next = this->_free;
+			this->_free = block;
+			this->_in_use--;
+		}
+
+		// Occupancy, read without the lock: a snapshot for STATS
+		// Other threads allocate meanwhile (STATS p), read atomically
+		size_t inUse() const
+		{
+			return __sync_fetch_and_add(const_cast<size_t *>(&this->_in_use), 0);
+		}
+		size_t capacity() const
+		{
+			return __sync_fetch_and_add(const_cast<size_t *>(&this->_capacity), 0);
+		}
+};
+
+// STL allocator drawing single nodes (std::set, std::map, std::list) from
+// the shared pool of the node type; arrays still use operator new
+template <typename T>
+class PoolAllocator
+{
+	public:
+		typedef T value_type;
+		typedef T *pointer;
+		typedef T const *const_pointer;
+		typedef T &reference;
+		typedef T const &const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		template <typename U>
+		struct rebind
+		{
+			typedef PoolAllocator<U> other;
+		};
+
+		PoolAllocator() {}
+		PoolAllocator(PoolAllocator const &) {}
+		template <typename U>
+		PoolAllocator(PoolAllocator<U> const &) {}
+		~PoolAllocator() {}
+
+		pointer address(reference value) const { return &value; }
+		const_pointer address(const_reference value) const { return &value; }
+
+		pointer allocate(size_type count, void const * = 0)
+		{
+			if (count == 1)
+				return static_cast<pointer>(ObjectPool<T>::shared().allocate());
+			return static_cast<pointer>(::operator new(count * sizeof(T)));
+		}
+
+		void deallocate(pointer pointer_value, size_type count)
+		{
+			if (count == 1)
+				ObjectPool<T>::shared().release(pointer_value);
+			else
+				::operator delete(pointer_value);
+		}
+
+		size_type max_size() const
+		{
+			return std::numeric_limits<size_type>::max() / sizeof(T);
+		}
+
+		void construct(pointer pointer_value, const_reference value)
+		{
+			new (pointer_value) T(value);
+		}
+
+		void destroy(pointer pointer_value)
+		{
+			pointer_value->~T();
+		}
+
+		bool operator==(PoolAllocator const &) const { return true; }
+		bool operator!=(PoolAllocator const &) const { return false; }
+};
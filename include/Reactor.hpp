@@ -0,0 +1,96 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reactor.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 10:02:11 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 10:02:11 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <poll.h>
+
+#include "FdTable.hpp"
+
+#ifdef __linux__
+# include <sys/epoll.h>
+#endif
+
+// Readiness interest / event flags (backend independent)
+#define IO_READ		0x01
+#define IO_WRITE	0x02
+#define IO_HANGUP	0x04	// peer hang up or socket error (output only)
+#define IO_EDGE		0x08	// edge-triggered notification, ignored by poll()
+
+#define REACTOR_MAX_EVENTS	256
+
+struct ReactorEvent
+{
+	int fd;
+	int events;
+};
+
+// Readiness notification backend used by the server event loop.
+// wait() only reports the descriptors that are ready, so callers
+// dispatch in O(ready fds) whatever the backend does internally.
+class Reactor
+{
+	public:
+		virtual ~Reactor();
+
+		virtual bool add(int fd, int events) = 0;
+		virtual bool modify(int fd, int events) = 0;
+		virtual void remove(int fd) = 0;
+		virtual int wait(std::vector<ReactorEvent> &ready, int timeout_ms) = 0;
+		virtual const char *getName() const = 0;
+
+		// Best available backend: epoll on Linux, poll() otherwise
+		static Reactor *create(void);
+};
+
+// Portable fallback, poll() itself still scans the whole pollfd array
+class PollReactor : public Reactor
+{
+	private:
+		FdTable<struct pollfd> _poll_fds;
+
+		static short _toPoll(int events);
+
+	public:
+		PollReactor();
+		~PollReactor();
+
+		bool add(int fd, int events);
+		bool modify(int fd, int events);
+		void remove(int fd);
+		int wait(std::vector<ReactorEvent> &ready, int timeout_ms);
+		const char *getName() const;
+};
+
+#ifdef __linux__
+class EpollReactor : public Reactor
+{
+	private:
+		int _epoll_fd;
+		struct epoll_event _events[REACTOR_MAX_EVENTS];
+
+		static unsigned int _toEpoll(int events);
+
+	public:
+		EpollReactor();
+		~EpollReactor();
+
+		bool isValid() const;
+		bool add(int fd, int events);
+		bool modify(int fd, int events);
+		void remove(int fd);
+		int wait(std::vector<ReactorEvent> &ready, int timeout_ms);
+		const char *getName() const;
+};
+#endif
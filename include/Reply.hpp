@@ -0,0 +1,53 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reply.hpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 21:24:37 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 21:24:37 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#include "Utils.hpp"
+
+// One outbound line, formatted in place in a fixed buffer (usually on the
+// caller's stack) instead of through temporaries or a stringstream.
+// The CRLF is always kept at the end; text past MAX_MESSAGE_LENGTH is cut.
+//
+//   Reply().numeric(server, RPL_TOPIC, nick).channel(name).trailing(topic)
+//   Reply().source(client->getPrefix()).word("PART").channel(name)
+class Reply
+{
+	private:
+		char _data[MAX_MESSAGE_LENGTH];
+		size_t _length;   // Text bytes, the CRLF follows them
+		bool _truncated;
+
+		void _append(const char *text, size_t length);
+
+	public:
+		Reply();
+
+		Reply &numeric(std::string const &server, int code, \
+			std::string const &target);
+		Reply &source(std::string const &prefix); // Verbatim, ":nick!user@host"
+		Reply &text(std::string const &text);     // Verbatim
+		Reply &text(const char *text);
+		Reply &word(std::string const &word);     // " word"
+		Reply &word(const char *word);
+		Reply &number(unsigned long value);       // " 42"
+		Reply &channel(std::string const &name);  // " #name"
+		Reply &trailing(std::string const &text); // " :text"
+		Reply &trailing(const char *text);
+
+		const char *data() const;
+		size_t length() const; // CRLF included
+		bool truncated() const;
+};
@@ -0,0 +1,73 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RingQueue.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 20:31:44 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 20:31:44 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#define RING_QUEUE_MIN	8	// Slots of the first allocation, power of two
+
+// FIFO over a power of two array that only grows. Unlike std::deque, a
+// queue that keeps being filled and drained never goes back to the heap
+// once it has reached its working size.
+template <typename T>
+class RingQueue
+{
+	private:
+		std::vector<T> _slots;
+		size_t _head;
+		size_t _count;
+
+		// Unrolls the queue into a twice as large array
+		void _grow()
+		{
+			size_t size = this->_slots.size();
+			std::vector<T> slots(size ? size * 2 : RING_QUEUE_MIN);
+
+			for (size_t i = 0; i < this->_count; i++)
+				slots[i] = this->_slots[(this->_head + i) & (size - 1)];
+			this->_slots.swap(slots);
+			this->_head = 0;
+		}
+
+	public:
+		RingQueue() : _head(0), _count(0) {}
+
+		bool empty() const { return this->_count == 0; }
+		size_t size() const { return this->_count; }
+
+		// i-th element from the front
+		T const &at(size_t i) const
+		{
+			return this->_slots[(this->_head + i) & (this->_slots.size() - 1)];
+		}
+
+		T const &front() const { return this->at(0); }
+
+		void push_back(T const &value)
+		{
+			if (this->_count == this->_slots.size())
+				this->_grow();
+			this->_slots[(this->_head + this->_count) \
+				& (this->_slots.size() - 1)] = value;
+			this->_count++;
+		}
+
+		// The slot is reset so it stops holding on to the value
+		void pop_front()
+		{
+			this->_slots[this->_head] = T();
+			this->_head = (this->_head + 1) & (this->_slots.size() - 1);
+			this->_count--;
+		}
+};
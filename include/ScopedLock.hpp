@@ -0,0 +1,36 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ScopedLock.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 17:12:40 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 17:12:40 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <pthread.h>
+
+// Holds a mutex for the lifetime of the object, so early returns unlock
+class ScopedLock
+{
+	private:
+		pthread_mutex_t &_mutex;
+
+		ScopedLock(ScopedLock const &other);
+		ScopedLock &operator=(ScopedLock const &other);
+
+	public:
+		explicit ScopedLock(pthread_mutex_t &mutex) : _mutex(mutex)
+		{
+			pthread_mutex_lock(&this->_mutex);
+		}
+
+		~ScopedLock()
+		{
+			pthread_mutex_unlock(&this->_mutex);
+		}
+};
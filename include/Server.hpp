@@ -19,6 +19,7 @@
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <vector>
@@ -36,26 +37,23 @@
 #include "Utils.hpp"
 #include "Client.hpp"
 #include "Channel.hpp"
-
-// IRC COMMAND CODES - ARBITRARY
-#define JOIN 100
-#define PRIVMSG 101
-#define NICK 102
-#define QUIT 103
-#define PART 104
-#define PASS 105
-#define USER 106
-#define KICK 107
-#define INVITE 108
-#define TOPIC 109
-#define MODE 110
-#define PONG 111
-#define NOTICE 112
-#define NO_COMM -1
-
+#include "Reactor.hpp"
+#include "FdTable.hpp"
+#include "HashIndex.hpp"
+#include "IrcMessage.hpp"
+#include "Shard.hpp"
+#include "ScopedLock.hpp"
+#include "Reply.hpp"
 
 // IRC REPLY CODE - RFC 1459 PROTOCOL
 #define RPL_WELCOME 001
+#define RPL_STATSCOMMANDS 212
+#define RPL_ENDOFSTATS 219
+#define RPL_STATSDEBUG 249
+#define RPL_CHANNELMODEIS 324
+#define RPL_NOTOPIC 331
+#define RPL_TOPIC 332
+#define RPL_INVITING 341
 #define RPL_NAMREPLY 353
 #define RPL_ENDOFNAMES 366
 #define ERR_NOSUCHNICK 401
@@ -67,6 +65,7 @@
 #define ERR_NONICKNAMEGIVEN 431
 #define ERR_ERRONEUSNICKNAME 432
 #define ERR_NICKNAMEINUSE 433
+#define ERR_NOTREGISTERED 451
 #define ERR_USERNOTINCHANNEL 441
 #define ERR_NOTONCHANNEL 442
 #define ERR_USERONCHANNEL 443
@@ -80,73 +79,194 @@
 #define ERR_BADCHANNELKEY 475
 #define ERR_CHANOPRIVSNEEDED 482
 
+// Outbound queue limits (bytes), overridable from the command line
+#define DEFAULT_SENDQ_MAX			65536
+#define DEFAULT_SENDQ_TOTAL_MAX		67108864
+
+// Keepalive timings (seconds), overridable from the command line
+#define DEFAULT_PING_INTERVAL		120	// Idle time before the server sends a PING
+#define DEFAULT_PING_TIMEOUT		60	// Time allowed to answer it
+#define DEFAULT_REGISTRATION_TIMEOUT	60
+
+// Objects preallocated at startup, the pools grow past them on demand
+#define DEFAULT_POOL_CLIENTS		256
+#define DEFAULT_POOL_CHANNELS		64
+
+#define MAX_THREADS					64
+#define DEFAULT_LISTEN_BACKLOG		SOMAXCONN
+#define MAX_LISTEN_BACKLOG			65535
+#define ACCEPT_BATCH_MAX			64	// Connections taken per readiness event
+#define ACCEPT_PAUSE_MS				100	// Listener rest after fd/memory exhaustion
+#define ACCEPT_LOG_INTERVAL_MS		1000	// At most one accept error line per shard
+#define CLOSE_LINGER				2	// Seconds a closing client has to read its last reply
+
 class Client;
 class Channel;
+class Server;
+
+// Runtime tunables, filled by main() from the optional arguments
+struct ServerConfig
+{
+	size_t sendq_max;		// Per client outbound queue cap
+	size_t sendq_total_max;	// Outbound memory budget for all clients
+	size_t threads;			// Event loop shards, one thread each
+	size_t listen_backlog;	// Pending connection queue of each listener
+	size_t pool_clients;	// Client objects preallocated
+	size_t pool_channels;	// Channel objects preallocated
+	size_t ping_interval;
+	size_t ping_timeout;
+	size_t registration_timeout;
+
+	ServerConfig();
+};
+
+// Command handlers share one signature so they can sit in a table
+typedef void (Server::*CommandHandler)(IrcMessage const &msg, int client_fd);
+
+// One entry of the static command table (see ServerDispatch.cpp)
+struct CommandSpec
+{
+	const char *name;			// Verb, matched case insensitively
+	CommandHandler handler;		// NULL: accepted and ignored
+	size_t min_params;			// Non empty parameters required
+	bool needs_registration;
+};
+
+#define LATENCY_BUCKETS 16	// Bucket i counts runs under 2^i us, last one is open
+
+// Per command invocation counter and latency histogram, reported by STATS m
+struct CommandStats
+{
+	unsigned long count;
+	unsigned long total_ns;
+	unsigned long max_ns;
+	unsigned long buckets[LATENCY_BUCKETS];
+
+	CommandStats();
+	void record(unsigned long ns);
+};
 
 class Server
 {
+	friend class BenchAccess;
+
 	private:
 	
 		int _port;
 		std::string _password;
-		int _server_fd;
 		sockaddr_in _server_addr;
-		std::vector<struct pollfd> _poll_fds;
-		std::map<int, Client*> _clients;
-		std::map<std::string, Channel*> _channels;
+		std::vector<Shard*> _shards; //Event loops, clients live in exactly one
+		HashIndex<Client*> _nicks; //Registered nickname -> client
+		HashIndex<Channel*, IrcCaseKey> _channels; //Case folded name -> channel
 		std::string _server_name;
+		ServerConfig _config;
+		std::vector<CommandStats> _command_stats; //Indexed like the command table
+		// Held by a shard while it touches state shared between shards:
+		// nicks, channels, client identities and the command statistics
+		pthread_mutex_t _world_lock;
+		volatile sig_atomic_t _stopping;
+		volatile sig_atomic_t _disconnect_request; //Bumped by disconnectAll()
 	
 		// Private initialization methods
 		bool _checkPassword(std::string const &client_pass);
-		int _createSocket(void);
-		int _bindSocket(void);
-		int _listenSocket(void);
+		int _createSocket(bool reuse_port);
+		int _bindSocket(int listen_socket);
+		int _listenSocket(int listen_socket);
+		bool _initShard(Shard *shard);
+
+		//Event loop shards
+		static void *_shardMain(void *shard);
+		static Shard *_currentShard(void);
+		static void _enterShard(Shard *shard);
+		void _runShard(Shard *shard);
+		void _deliverMail(Shard *shard);
+		void _disconnectShard(Shard *shard);
+
+		//Client timers (registration, keepalive)
+		void _armClientTimer(Client *client, size_t seconds);
+		void _expireTimers(Shard *shard);
+		void _clientTimer(Client *client);
 
 		//Private management methods
 		void _acceptNewClient(void);
+		void _pauseAccept(Shard *shard, int error);
+		int _resumeAccept(Shard *shard, int timeout);
+		void _addClient(Shard *shard, int client_socket, \
+			sockaddr_in const &client_addr);
 		void _handleClientData(int client_fd);
 		void _removeClient(int client_fd);
 
+		//Outbound queue handling
+		void _scheduleFlush(Client *client);
+		void _flushPending(void);
+		void _endOfTick(void);
+		void _flushClient(Client *client);
+		void _scheduleQuit(Client *client, std::string const &reason);
+		void _closeClient(Client *client);
+		void _processPendingQuits(void);
+
 		//Message handling
-		void _sendErrorReply(int client_fd, int code, const std::string &message);
+		void _sendErrorReply(int client_fd, int code, const char *message);
+		void _sendErrorReply(int client_fd, int code, std::string const &param, \
+			const char *message);
+		void _sendChannelError(int client_fd, int code, std::string const &channel, \
+			const char *message);
+		void _sendChannelError(int client_fd, int code, std::string const &nick, \
+			std::string const &channel, const char *message);
 		void _welcomeMessage(Client *client);
 		std::string _checkDoubles (std::string const &nickname, int client_fd);
+		void _setNickname(Client *client, std::string const &nickname);
+		void _destroyChannel(Channel *channel);
+		void _reportCommandStats(Client *client);
 		
 		//Input validation
 		bool _isValidNickname(const std::string &nickname);
 		bool _isValidChannelName(const std::string &channelName);
-		std::vector<std::string> _splitMessage(const std::string &message);
 	
 	public:
-		Server(int port, std::string password);
+		Server(int port, std::string password, \
+			ServerConfig const &config = ServerConfig());
 		~Server();
 
 		//Main public methods
 		bool serverInit(void);
 		void run(void);
+		void stop(void);
+		void disconnectAll(void);
 		int getServerFd(void);
 		std::string getServerName(void) const;
 		
 		//Client management methods
 		Client *getClient(int client_fd);
 		Client *getClientByNick(std::string const &nick);
-		void changeNick(std::string const &data, int client_fd);
-		void sendMessageToTarget(std::string const &data, int client_fd, int type = PRIVMSG);
-		void joinChannel(std::string const &data, int client_fd);
-		void partChannel(std::string const &data, int client_fd);
-		void quitServer(std::string const &data, int client_fd, std::string msg = "Client quit");
-		void kickUser(std::string const &data, int client_fd);
-		void inviteUser(std::string const &data, int client_fd);
+		void sendToClient(Client *client, SharedMessage const &message);
+		void sendToClient(Client *client, std::string const &message);
+		void sendToClient(Client *client, Reply const &reply);
+		void sendToClient(int client_fd, std::string const &message);
+		void changeNick(IrcMessage const &msg, int client_fd);
+		void sendMessageToTarget(IrcMessage const &msg, int client_fd, \
+			std::string const &command);
+		void privmsgCommand(IrcMessage const &msg, int client_fd);
+		void noticeCommand(IrcMessage const &msg, int client_fd);
+		void joinChannel(IrcMessage const &msg, int client_fd);
+		void partChannel(IrcMessage const &msg, int client_fd);
+		void quitServer(int client_fd, std::string const &reason = "Client quit");
+		void quitCommand(IrcMessage const &msg, int client_fd);
+		void pongCommand(IrcMessage const &msg, int client_fd);
+		void kickUser(IrcMessage const &msg, int client_fd);
+		void inviteUser(IrcMessage const &msg, int client_fd);
 
 		//Channel management methods
 		Channel *getChannelByName(std::string const &name);
-		void topicCommand(std::string const &data, int client_fd);
-		void modeCommand(std::string const &data, int client_fd);
-		void handleChannelMode(std::string const &data, int client_fd);
+		void topicCommand(IrcMessage const &msg, int client_fd);
+		void modeCommand(IrcMessage const &msg, int client_fd);
+		void handleChannelMode(IrcMessage const &msg, int client_fd);
+		void statsCommand(IrcMessage const &msg, int client_fd);
 		
 		//Server command methods
-		int parseCommand(const std::string& data);
-		bool executeCommand(int client_fd, int command_code, std::string const &data);
+		static size_t commandCount(void);
+		static CommandSpec const *findCommand(IrcToken const &verb);
+		bool executeCommand(int client_fd, IrcMessage const &msg);
 
 		//Server clean up method
 		void cleanUp();
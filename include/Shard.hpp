@@ -0,0 +1,101 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Shard.hpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 17:12:40 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 17:12:40 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <vector>
+#include <ctime>
+#include <pthread.h>
+
+#include "Reactor.hpp"
+#include "FdTable.hpp"
+#include "SharedMessage.hpp"
+#include "TimerWheel.hpp"
+
+class Client;
+class Server;
+
+// I/O counters of one shard, summed by STATS z
+struct ShardStats
+{
+	unsigned long commands;		// Lines processed
+	unsigned long read_calls;	// recv() calls
+	unsigned long write_calls;	// writev() calls
+	unsigned long bytes_out;
+	unsigned long replies_truncated;	// Replies cut at MAX_MESSAGE_LENGTH
+	unsigned long accepted;		// Connections accepted
+	unsigned long accept_peak;	// Most connections accepted in one second
+	unsigned long accept_queue_peak;	// Deepest accept queue seen (TCP_INFO)
+	unsigned long accept_queue_full;	// Accept wakeups that found it at its limit
+	unsigned long accept_queue_limit;	// Limit the kernel applies, 0 if unknown
+	unsigned long accept_failures;	// accept() errors that paused the listener
+	time_t accept_second;		// Second accepted_second counts for
+	unsigned long accepted_second;
+	unsigned long accepted_last;	// Count of the second before accept_second
+
+	ShardStats();
+	void countAccepts(unsigned long count, time_t now);
+	unsigned long acceptRate(time_t now) const;
+	void countAcceptQueue(unsigned long depth, unsigned long limit);
+	ShardStats snapshot(void) const;
+};
+
+// Line queued by another shard for one of this shard's clients.
+// The id tells a reused fd apart from the intended client.
+struct MailItem
+{
+	int fd;
+	unsigned long client_id;
+	SharedMessage message;
+};
+
+// One event loop thread with its own listening socket (SO_REUSEPORT),
+// reactor and clients. Everything but the mailbox is only touched by the
+// shard's own thread; other shards hand it output through post().
+struct Shard
+{
+	Server *server;
+	int index;
+	int listen_fd;
+	Reactor *reactor;
+	FdTable<Client*> clients;
+	std::vector<int> flush_queue;   // Clients with output produced this tick
+	std::vector<int> flushing;      // flush_queue being walked, kept for its capacity
+	std::vector<int> pending_quits; // Clients to drop once the event batch is done
+	TimerWheel timers;              // One timer per client, see Server::_clientTimer()
+	std::vector<MailItem> mail;     // Mailbox being delivered, kept for its capacity
+	ShardStats stats;
+	int disconnect_seen;            // Last Server::disconnectAll() request handled
+	unsigned long accept_resume_ms; // When a paused listener is watched again, 0 if not paused
+	unsigned long accept_logged_ms; // Last accept error line, for rate limiting
+	unsigned long accept_unlogged;  // Errors since that line
+	pthread_t thread;
+
+	Shard(Server *server, int index);
+	~Shard();
+
+	bool initWakeup(void);
+	int getWakeFd(void) const;
+	void wake(void);
+	void clearWakeup(void);
+
+	void post(Client *client, SharedMessage const &message);
+	void takeMail(std::vector<MailItem> &out);
+
+	private:
+		pthread_mutex_t _mailbox_lock;
+		std::vector<MailItem> _mailbox;
+		int _wake_fds[2]; // Self pipe, readable while mail is waiting
+
+		Shard(Shard const &other);
+		Shard &operator=(Shard const &other);
+};
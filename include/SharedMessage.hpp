@@ -0,0 +1,54 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SharedMessage.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 15:12:36 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 15:12:36 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Immutable outbound line, formatted once and shared by reference between
+// every send queue it is in. The text is freed when the last copy of the
+// handle goes away, i.e. when the last recipient has flushed it.
+// Reference counts are atomic: copies may live in queues of other shards.
+// Counter and text share one block. Protocol sized blocks are recycled
+// through a small per-thread list, longer ones come from the heap.
+class SharedMessage
+{
+	private:
+		struct Buffer
+		{
+			unsigned int refs;
+			size_t length; // The text follows the header
+		};
+
+		Buffer *_buffer;
+
+		static size_t _live_bytes;	// Text bytes held by all live buffers
+
+		void _create(const char *data, size_t length);
+		void _release(void);
+
+	public:
+		SharedMessage();
+		explicit SharedMessage(std::string const &data);
+		SharedMessage(const char *data, size_t length);
+		SharedMessage(SharedMessage const &other);
+		SharedMessage &operator=(SharedMessage const &other);
+		~SharedMessage();
+
+		const char *data(void) const;
+		size_t length(void) const;
+		bool empty(void) const;
+
+		static size_t getLiveBytes(void);
+		static void releaseCache(void); // Spare blocks of the calling thread
+};
@@ -0,0 +1,60 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 18:52:07 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 18:52:07 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#define TIMER_TICK_MS	250	// Resolution of every timeout
+#define TIMER_BITS		6
+#define TIMER_SLOTS		(1 << TIMER_BITS)
+#define TIMER_LEVELS	3	// 64 x 250ms, 64 x 16s, 64 x 17min (about 18h)
+
+// Intrusive list entry, embedded in whatever the timer belongs to so arming
+// and cancelling never allocate
+struct TimerNode
+{
+	TimerNode *prev;
+	TimerNode *next;
+	unsigned long expires; // Tick
+	int fd;                // Passed back when the timer fires
+
+	TimerNode();
+	bool isArmed() const;
+};
+
+// Hierarchical timing wheel: a timer sits in the coarsest level whose range
+// covers its delay and moves down a level each time the finer wheel wraps,
+// so arming, cancelling and expiring are all O(1) per timer
+class TimerWheel
+{
+	private:
+		TimerNode _slots[TIMER_LEVELS][TIMER_SLOTS]; //List heads
+		unsigned long _current; //Last tick processed
+		size_t _count;
+
+		void _insert(TimerNode *node);
+		void _cascade(int level);
+
+		TimerWheel(TimerWheel const &other);
+		TimerWheel &operator=(TimerWheel const &other);
+
+	public:
+		TimerWheel();
+
+		void schedule(TimerNode *node, unsigned long due_ms);
+		void cancel(TimerNode *node);
+		void advance(unsigned long now_ms, std::vector<int> &expired);
+		int nextTimeout(unsigned long now_ms) const;
+		size_t size() const;
+};
@@ -21,8 +21,7 @@
 #include <ctime>
 #include <iomanip>
 
-#define LOG 0
-#define ERR 1
+#include "Log.hpp"
 
 // Terminal Colors
 #define WHITE   "\033[37m"
@@ -43,15 +42,13 @@
 #define MAX_CHANNELS_PER_USER	10
 #define MAX_USERS_PER_CHANNEL	100
 
-// log generation functions
-void logMessage(std::string msg, std::string msg_color, std::string args, std::string args_color, int type = LOG);
-
 // Conversions and validation
 std::string itoa(int number);
 bool isNum(const std::string &str);
 bool isValidPort(int port);
 bool isValidNickChar(char c);
 bool isValidChannelChar(char c);
+unsigned long monotonicMs(void);
 
 // IRC specific manipulations
 bool isValidNickname(const std::string &nickname);
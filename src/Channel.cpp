@@ -12,13 +12,34 @@
 
 #include "../include/Channel.hpp"
 
+static ObjectPool<Channel> g_channel_pool;
+
+ObjectPool<Channel> &Channel::pool()
+{
+	return g_channel_pool;
+}
+
+void *Channel::operator new(size_t size)
+{
+	(void)size; // Always sizeof(Channel), nothing derives from it
+	return g_channel_pool.allocate();
+}
+
+void Channel::operator delete(void *pointer)
+{
+	g_channel_pool.release(pointer);
+}
+
 Channel::Channel(std::string const &name, std::string const &password) \
-				: _name(name), _password(password), _key(""), _user_limit(0)
+				: _name(name), _password(password), _key(""), _names_budget(0), \
+				_names_bytes(0), \
+				_user_limit(0)
 {
 	this->_creation_time = time(NULL);
 	// Default modes for new channels
-	this->_modes.insert(MODE_NO_EXTERNAL_MSGS);	// +n by default
-	this->_modes.insert(MODE_TOPIC_PROTECT);	// +t by default
+	this->_modes = _modeBit(MODE_NO_EXTERNAL_MSGS)	// +n by default
+		| _modeBit(MODE_TOPIC_PROTECT);				// +t by default
+	this->_updateModeString();
 	logMessage("Channel created: ", GREEN, name, BLUE);
 }
 
@@ -28,29 +49,29 @@ Channel::~Channel()
 }
 
 // Getters
-std::string Channel::getName() const
+std::string const &Channel::getName() const
 {
 	return this->_name;
 }
 
-std::string Channel::getTopic() const
+std::string const &Channel::getTopic() const
 {
 	return this->_topic;
 }
 
-std::string Channel::getPassword() const
+std::string const &Channel::getPassword() const
 {
 	return this->_password;
 }
 
-std::string Channel::getKey() const
+std::string const &Channel::getKey() const
 {
 	return this->_key;
 }
 
 size_t Channel::getUserCount() const
 {
-	return this->_userlist.size();
+	return this->_members.size();
 }
 
 size_t Channel::getUserLimit() const
@@ -72,86 +93,115 @@ void Channel::setTopic(std::string const &topic)
 }
 
 // User management
-bool Channel::addUser(std::string const &user, std::string const &password)
+bool Channel::addUser(Client *client, std::string const &password)
 {
-	// Remove spaces and control characters from username
-	std::string cleanUser = user;
-	size_t pos = cleanUser.find_first_of(" \r\n\t");
-	if (pos != std::string::npos)
-		cleanUser.erase(pos);
-
-	if (cleanUser.empty())
+	if (!client || client->getNickname().empty())
 		return false;
 
-	if (this->_userlist.find(cleanUser) != this->_userlist.end())
+	if (this->hasUser(client))
 		return true; // Not an error: the user is already on the channel
 
-	if (!canUserJoin(cleanUser, password))
+	if (!canUserJoin(client, password))
 		return false;
-	this->_userlist.insert(cleanUser);
+
+	ChannelMember member;
+	member.client = client;
+	member.flags = 0;
+	member.names_chunk = 0;
 
 	// First user becomes operator
-	if (this->_userlist.size() == 1)
-		this->_operators.insert(cleanUser);
+	if (this->_members.empty())
+		member.flags |= MEMBER_OP;
+
+	client->linkChannel(this, this->_members.size());
+	this->_members.push_back(member);
+	if (this->_names_budget)
+		this->_appendName(this->_members.back()); // Joins land at the end
 
 	// Remove from invite list if present
-	this->_invited.erase(cleanUser);
+	this->_invited.erase(client->getId());
 
 	logMessage("User joined channel ", GREEN, this->_name + ": " \
-		+ cleanUser, BLUE);
+		+ client->getNickname(), BLUE);
 	return true;
 }
 
-bool Channel::removeUser(std::string const &user)
+bool Channel::removeUser(Client *client)
 {
-	if (this->_userlist.find(user) == this->_userlist.end())
+	int slot = client->getChannelSlot(this);
+	if (slot == -1)
 		return false;
-	
-	this->_userlist.erase(user);
-	this->_operators.erase(user);
 
-	logMessage("User left channel ", YELLOW,this->_name + ": " + user, BLUE);
+	ChannelMember leaving = this->_members[slot];
+
+	// Fill the hole with the last member and repoint its back link
+	size_t last = this->_members.size() - 1;
+	if (static_cast<size_t>(slot) != last)
+	{
+		this->_members[slot] = this->_members[last];
+		this->_members[slot].client->relinkChannel(this, slot);
+	}
+	this->_members.pop_back();
+	client->unlinkChannel(this);
+
+	// Only this member's entry leaves the cached NAMES chunks
+	if (this->_names_budget)
+	{
+		this->_removeName(leaving, this->_nameEntry(leaving));
+		this->_compactNames();
+	}
+
+	logMessage("User left channel ", YELLOW,this->_name + ": " \
+		+ client->getNickname(), BLUE);
 	return true;
 }
 
-bool Channel::hasUser(std::string const &user) const
+bool Channel::hasUser(Client const *client) const
 {
-	return (this->_userlist.find(user) != this->_userlist.end());
+	return (client && client->getChannelSlot(this) != -1);
 }
 
-std::vector<std::string> Channel::getUserList() const
+std::vector<ChannelMember> const &Channel::getMembers() const
 {
-	std::vector<std::string> users;
-	for (std::set<std::string>::const_iterator it = this->_userlist.begin(); \
-		it != this->_userlist.end(); ++it)
-		users.push_back(*it);
-	return users;
+	return this->_members;
 }
 
-std::string Channel::getUserListString() const
+// NAMES payload split so that no chunk is longer than budget (a single
+// entry aside). Kept between calls and edited one entry at a time: joins
+// append, parts and kicks cut the entry out of its chunk, op and nick
+// changes move it. Chunks can end up empty, callers skip those.
+std::vector<std::string> const &Channel::getNames(size_t budget)
 {
-	std::string result;
-	for (std::set<std::string>::const_iterator it = this->_userlist.begin(); \
-		it != this->_userlist.end(); ++it)
+	if (this->_names_budget != budget)
 	{
-		if (!result.empty())
-			result += " ";
-		result += this->_getUserModePrefix(*it) + *it;
+		this->_names_budget = budget;
+		this->_rebuildNames();
 	}
-	return result;
+	return this->_names;
+}
+
+// Nick changes only touch the one entry
+void Channel::renameUser(Client *client, std::string const &old_nick)
+{
+	ChannelMember *member = this->_findMember(client);
+	if (!member || !this->_names_budget)
+		return;
+	this->_updateName(*member, \
+		this->_getUserModePrefix(member->flags) + old_nick);
 }
 
 // Handle invitation
-bool Channel::inviteUser(std::string const &user)
+bool Channel::inviteUser(Client const *client)
 {
-	this->_invited.insert(user);
-	logMessage("User invited to ", GREEN,this->_name + ": " + user, BLUE);
+	this->_invited.insert(client->getId());
+	logMessage("User invited to ", GREEN,this->_name + ": " \
+		+ client->getNickname(), BLUE);
 	return true;
 }
 
-bool Channel::isInvited(std::string const &user) const
+bool Channel::isInvited(Client const *client) const
 {
-	return (this->_invited.find(user) != this->_invited.end());
+	return (this->_invited.find(client->getId()) != this->_invited.end());
 }
 
 // Validations
@@ -160,7 +210,7 @@ bool Channel::isPasswordRequired() const
 	return !this->_password.empty();
 }
 
-bool Channel::canUserJoin(std::string const &user, \
+bool Channel::canUserJoin(Client const *client, \
 	std::string const &password) const
 {
 	// Check password
@@ -168,12 +218,12 @@ bool Channel::canUserJoin(std::string const &user, \
 		return false;
 
 	// Check invite-only mode
-	if (hasMode(MODE_INVITE_ONLY) && !isInvited(user))
+	if (hasMode(MODE_INVITE_ONLY) && !isInvited(client))
 		return false;
 
 	// Check user limit
 	if (hasMode(MODE_LIMIT) &&this->_user_limit > 0 \
-		&& this->_userlist.size() >= this->_user_limit)
+		&& this->_members.size() >= this->_user_limit)
 		return false;
 
 	// Check key mode
@@ -183,14 +233,14 @@ bool Channel::canUserJoin(std::string const &user, \
 	return true;
 }
 
-bool Channel::canUserSetTopic(std::string const &user) const
+bool Channel::canUserSetTopic(Client const *client) const
 {
-	if (!hasUser(user))
+	if (!hasUser(client))
 		return false;
 
 	// If topic protection is on, only operators can set topic
 	if (hasMode(MODE_TOPIC_PROTECT))
-		return isOp(user);
+		return isOp(client);
 
 	return true;
 }
@@ -198,57 +248,147 @@ bool Channel::canUserSetTopic(std::string const &user) const
 // Empty channel checking
 bool Channel::isEmpty() const
 {
-	return this->_userlist.empty();
+	return this->_members.empty();
 }
 
 // Private methods
 bool Channel::_hasMode(char mode) const
 {
-	return (this->_modes.find(mode) != this->_modes.end());
+	return (this->_modes & _modeBit(mode)) != 0;
 }
 
-void Channel::_broadcastToChannel(Server *server, const std::string &message, int exclude_fd)
+// Bit of a mode letter, 0 for letters that are not channel modes
+unsigned int Channel::_modeBit(char mode)
 {
-	for (std::set<std::string>::const_iterator it = this->_userlist.begin(); \
-		it != this->_userlist.end(); ++it)
+	switch (mode)
 	{
-		Client *client = server->getClientByNick(*it);
-		if (client && client->getFd() != exclude_fd)
-		{
-			if (send(client->getFd(), message.c_str(), message.length(), 0) == -1)
-				logMessage("ERROR: ", RED, "Failed to broadcast to " \
-					+ *it, YELLOW, ERR);
-		}
+		case MODE_INVITE_ONLY:		return 0x01;
+		case MODE_KEY:				return 0x02;
+		case MODE_LIMIT:			return 0x04;
+		case MODE_MODERATED:		return 0x08;
+		case MODE_NO_EXTERNAL_MSGS:	return 0x10;
+		case MODE_PRIVATE:			return 0x20;
+		case MODE_SECRET:			return 0x40;
+		case MODE_TOPIC_PROTECT:	return 0x80;
+		default:					return 0;
 	}
 }
 
-std::string Channel::_getUserModePrefix(const std::string &nickname) const
+void Channel::_updateModeString()
 {
-	if (isOp(nickname))
+	const char *letters = MODE_LETTERS;
+
+	this->_mode_string = "+";
+	for (size_t i = 0; letters[i]; i++)
+	{
+		if (this->_hasMode(letters[i]))
+			this->_mode_string += letters[i];
+	}
+	if (this->_hasMode(MODE_KEY) && !this->_key.empty())
+		this->_mode_string += " " + this->_key;
+	if (this->_hasMode(MODE_LIMIT) && this->_user_limit > 0)
+		this->_mode_string += " " + itoa(this->_user_limit);
+}
+
+// The line is formatted once and every member queue holds a reference to it
+void Channel::_broadcastToChannel(Server *server, SharedMessage const &message, Client *exclude)
+{
+	for (size_t i = 0; i < this->_members.size(); i++)
+	{
+		if (this->_members[i].client != exclude)
+			server->sendToClient(this->_members[i].client, message);
+	}
+}
+
+std::string Channel::_getUserModePrefix(unsigned int flags) const
+{
+	if (flags & MEMBER_OP)
 		return "@";
 	return "";
 }
 
-bool Channel::updateUserNick(const std::string &oldNick, const std::string &newNick)
+std::string Channel::_nameEntry(ChannelMember const &member) const
+{
+	return this->_getUserModePrefix(member.flags) \
+		+ member.client->getNickname();
+}
+
+void Channel::_appendName(ChannelMember &member)
 {
-	if (this->_userlist.find(oldNick) == this->_userlist.end())
-		return false; // User is not in the channel
+	std::string entry = this->_nameEntry(member);
+
+	if (this->_names.empty() \
+		|| this->_names.back().size() + 1 + entry.size() > this->_names_budget)
+		this->_names.push_back(entry);
+	else
+		this->_names.back().append(" ").append(entry);
+	member.names_chunk = this->_names.size() - 1;
+	this->_names_bytes += entry.size() + 1;
+}
 
-	this->_userlist.erase(oldNick); // Removes old nickname
-	this->_userlist.insert(newNick); // Adds new nickname
+// Cuts one space separated entry out of its chunk, O(chunk) whatever the
+// member count
+void Channel::_removeName(ChannelMember const &member, \
+	std::string const &entry)
+{
+	std::string &chunk = this->_names[member.names_chunk];
+	size_t pos = chunk.find(entry);
+	size_t end = pos + entry.size();
 
-	// Updates operator nickname
-	if (this->_operators.find(oldNick) != this->_operators.end())
+	// "bob" must not match inside "@bob" or "bobby"
+	while (pos != std::string::npos && !((pos == 0 || chunk[pos - 1] == ' ') \
+		&& (end == chunk.size() || chunk[end] == ' ')))
 	{
-		this->_operators.erase(oldNick);
-		this->_operators.insert(newNick);
+		pos = chunk.find(entry, pos + 1);
+		end = pos + entry.size();
 	}
-	
-	// Removes old nickname from banned and invited lists
-	this->_banned.erase(oldNick);
-	this->_invited.erase(oldNick);
-	
-	logMessage("Nick updated in channel ", GREEN, this->_name \
-		+ ": " + oldNick + " -> " + newNick, BLUE);
-	return true;
+	if (pos == std::string::npos)
+		return;
+
+	// Take one neighbouring separator along
+	if (end < chunk.size())
+		chunk.erase(pos, entry.size() + 1);
+	else if (pos > 0)
+		chunk.erase(pos - 1, entry.size() + 1);
+	else
+		chunk.clear();
+	this->_names_bytes -= entry.size() + 1;
+}
+
+// Once the chunks are mostly holes, repack them: that takes at least as
+// many removals as there are entries, so it stays O(1) amortized
+void Channel::_compactNames()
+{
+	if (this->_names.size() > 2 * (this->_names_bytes / this->_names_budget + 1))
+		this->_rebuildNames();
+}
+
+// The member's entry changed from old_entry (op status or nick)
+void Channel::_updateName(ChannelMember &member, std::string const &old_entry)
+{
+	if (!this->_names_budget)
+		return;
+	this->_removeName(member, old_entry);
+	this->_appendName(member);
+	this->_compactNames();
+}
+
+void Channel::_rebuildNames()
+{
+	this->_names.clear();
+	this->_names_bytes = 0;
+	for (size_t i = 0; i < this->_members.size(); i++)
+		this->_appendName(this->_members[i]);
+}
+
+ChannelMember *Channel::_findMember(Client const *client)
+{
+	int slot = client ? client->getChannelSlot(this) : -1;
+	return (slot == -1) ? NULL : &this->_members[slot];
+}
+
+ChannelMember const *Channel::_findMember(Client const *client) const
+{
+	int slot = client ? client->getChannelSlot(this) : -1;
+	return (slot == -1) ? NULL : &this->_members[slot];
 }
@@ -19,102 +19,96 @@ bool Channel::connect(Server *server, int client_fd)
 	if (!client)
 		return false;
 
-	std::string nick = client->getNickname();
-
 	// Send JOIN confirmation
-	std::string join_msg = ":" + nick + "!" + client->getUsername() \
-	+ "@" + client->getHostname() + " JOIN #" + this->_name + "\r\n";
-	send(client_fd, join_msg.c_str(), join_msg.length(), 0);
+	server->sendToClient(client, Reply().source(client->getPrefix()) \
+		.word("JOIN").channel(this->_name));
 
 	// Send topic if exists
 	if (!_topic.empty())
-	{
-		std::string topic_msg = ":" + server->getServerName() + " 332 " \
-		+ nick + " #" + this->_name + " :" + this->_topic + "\r\n";
-		send(client_fd, topic_msg.c_str(), topic_msg.length(), 0);
-	}
+		server->sendToClient(client, Reply().numeric(server->getServerName(), \
+			RPL_TOPIC, client->getNickname()).channel(this->_name) \
+			.trailing(this->_topic));
 	
 	// Send NAMES list
-	std::string names_msg = ":" + server->getServerName() + " 353 " \
-	+ nick + " = #" + this->_name + " :" + getUserListString() + "\r\n";
-	send(client_fd, names_msg.c_str(), names_msg.length(), 0);
-	
-	std::string end_names = ":" + server->getServerName() + " 366 " \
-	+ nick + " #" + this->_name + " :End of /NAMES list\r\n";
-	send(client_fd, end_names.c_str(), end_names.length(), 0);
-
-	client->joinChannel("#" + this->_name);
+	this->sendNames(server, client);
 	return true;
 }
 
-void Channel::sendMessage(Server *server, const std::string &sender, \
-std::string const msg, std::string command)
+// 353 lines, as many as the list needs to fit in 512 bytes each, then 366
+void Channel::sendNames(Server *server, Client *client)
 {
-	// Parse sender nickname
-	std::string sender_nick = sender;
-	size_t exclamation = sender.find('!');
-	if (exclamation != std::string::npos)
-		sender_nick = sender.substr(0, exclamation);
-
-	std::string formatted_msg = ":" + sender + " " + command \
-	+ " #" + _name + " " + msg + "\r\n";
-
-	for (std::set<std::string>::const_iterator it = _userlist.begin(); \
-		it != _userlist.end(); ++it)
+	std::string const &server_name = server->getServerName();
+	std::string const &nick = client->getNickname();
+
+	// ":server 353 nick = #name :" and the CRLF around the payload, with
+	// room for the longest nick so every joiner shares the same chunks
+	size_t nick_room = std::max(nick.size(), static_cast<size_t>(MAX_NICK_LENGTH));
+	size_t overhead = server_name.size() + nick_room + this->_name.size() + 14;
+	size_t budget = (overhead < MAX_MESSAGE_LENGTH / 2) \
+		? MAX_MESSAGE_LENGTH - overhead : MAX_MESSAGE_LENGTH / 2;
+
+	std::vector<std::string> const &names = this->getNames(budget);
+	for (size_t i = 0; i < names.size(); i++)
 	{
-		// Avoid delivering the message to its own sender
-		if (*it == sender_nick)
-			continue;
-
-		Client *client = server->getClientByNick(*it);
-		if (client)
-		{
-			if (send(client->getFd(), formatted_msg.c_str(), \
-				formatted_msg.length(), 0) == -1)
-				logMessage("ERROR: ", RED, "Failed to send message to " \
-					+ *it, YELLOW, ERR);
-		}
+		if (names[i].empty())
+			continue; // Every entry of that chunk left
+		server->sendToClient(client, Reply().numeric(server_name, \
+			RPL_NAMREPLY, nick).word("=").channel(this->_name) \
+			.trailing(names[i]));
 	}
+
+	server->sendToClient(client, Reply().numeric(server_name, \
+		RPL_ENDOFNAMES, nick).channel(this->_name) \
+		.trailing("End of /NAMES list"));
+}
+
+void Channel::sendMessage(Server *server, Client *sender, \
+std::string const &msg, std::string const &command)
+{
+	Reply line;
+	line.source(sender->getPrefix()).word(command).channel(this->_name) \
+		.word(msg);
+
+	// Avoid delivering the message to its own sender
+	this->_broadcastToChannel(server, SharedMessage(line.data(), \
+		line.length()), sender);
 }
 
 // Handle System Messages
 void Channel::announceJoin(Server *server, Client *client)
 {
-	std::string join_msg = ":" + client->getNickname() \
-	+ "!" + client->getUsername() + "@" + client->getHostname() \
-	+ " JOIN #" + this->_name + "\r\n";
-	this->_broadcastToChannel(server, join_msg);
+	Reply line;
+	line.source(client->getPrefix()).word("JOIN").channel(this->_name);
+	this->_broadcastToChannel(server, SharedMessage(line.data(), line.length()));
 }
 
 void Channel::announcePart(Server *server, Client *client, \
 const std::string &reason)
 {
-	std::string part_msg = ":" + client->getNickname() \
-	+ "!" + client->getUsername() + "@" + client->getHostname() \
-	+ " PART #" + this->_name;
+	Reply line;
+	line.source(client->getPrefix()).word("PART").channel(this->_name);
 	if (!reason.empty())
-		part_msg += " :" + reason;
-	part_msg += "\r\n";
+		line.trailing(reason);
 
-	this->_broadcastToChannel(server, part_msg);
+	this->_broadcastToChannel(server, SharedMessage(line.data(), line.length()));
 }
 
 void Channel::announceQuit(Server *server, Client *client, \
 	const std::string &reason)
 {
-	std::string quit_msg = ":" + client->getNickname() \
-	+ "!" + client->getUsername() + "@" + client->getHostname() \
-	+ " QUIT";
+	Reply line;
+	line.source(client->getPrefix()).word("QUIT");
 	if (!reason.empty())
-		quit_msg += " :" + reason;
-	quit_msg += "\r\n";
+		line.trailing(reason);
 
-	this->_broadcastToChannel(server, quit_msg, client->getFd());
+	this->_broadcastToChannel(server, SharedMessage(line.data(), line.length()), \
+		client);
 }
 
 void Channel::announceNickChange(Server *server, const std::string &oldNick, \
 	const std::string &newNick)
 {
-	std::string nick_msg = ":" + oldNick + " NICK :" + newNick + "\r\n";
-	this->_broadcastToChannel(server, nick_msg);
+	Reply line;
+	line.text(":").text(oldNick).word("NICK").trailing(newNick);
+	this->_broadcastToChannel(server, SharedMessage(line.data(), line.length()));
 }
@@ -17,7 +17,7 @@ bool Channel::setMode(char mode, bool enable, std::string const &param)
 {
 	if (enable)
 	{
-		this->_modes.insert(mode);
+		this->_modes |= _modeBit(mode);
 		if (mode == MODE_KEY)
 			this->_key = param;
 		else if (mode == MODE_LIMIT && !param.empty())
@@ -25,12 +25,13 @@ bool Channel::setMode(char mode, bool enable, std::string const &param)
 	}
 	else
 	{
-		this->_modes.erase(mode);
+		this->_modes &= ~_modeBit(mode);
 		if (mode == MODE_KEY)
 			this->_key.clear();
 		else if (mode == MODE_LIMIT)
 			this->_user_limit = 0;
 	}
+	this->_updateModeString();
 
 	logMessage("Mode change in ", BLUE,this->_name + ": " \
 				+ (enable ? "+" : "-") + mode, GREEN);
@@ -42,46 +43,43 @@ bool Channel::hasMode(char mode) const
 	return this->_hasMode(mode);
 }
 
-std::string Channel::getModeString() const
+// Built when the modes change, MODE queries just copy it out
+std::string const &Channel::getModeString() const
 {
-	std::string modes = "+";
-	for (std::set<char>::const_iterator it = this->_modes.begin(); \
-		it != this->_modes.end(); ++it)
-		modes += *it;
-
-	if (hasMode(MODE_KEY) && !_key.empty())
-		modes += " " + this->_key;
-	if (hasMode(MODE_LIMIT) &&this->_user_limit > 0)
-		modes += " " + itoa(this->_user_limit);
-
-	return modes;
+	return this->_mode_string;
 }
 
 // Operators management
-bool Channel::addOp(std::string const &user)
+bool Channel::addOp(Client *client)
 {
-	if (!hasUser(user))
+	ChannelMember *member = this->_findMember(client);
+	if (!member)
 		return false;
 
-	this->_operators.insert(user);
+	std::string old_entry = this->_nameEntry(*member);
+	member->flags |= MEMBER_OP;
+	this->_updateName(*member, old_entry);
 	logMessage("User became operator in ", GREEN,this->_name + ": " \
-		+ user, BLUE);
+		+ client->getNickname(), BLUE);
 	return true;
 }
 
-bool Channel::removeOp(std::string const &user)
+bool Channel::removeOp(Client *client)
 {
-	if (this->_operators.find(user) == this->_operators.end())
+	ChannelMember *member = this->_findMember(client);
+	if (!member || !(member->flags & MEMBER_OP))
 		return false;
 
-	this->_operators.erase(user);
+	std::string old_entry = this->_nameEntry(*member);
+	member->flags &= ~MEMBER_OP;
+	this->_updateName(*member, old_entry);
 	logMessage("User lost operator in ", YELLOW,this->_name + ": " \
-			+ user, BLUE);
+			+ client->getNickname(), BLUE);
 	return true;
 }
 
-bool Channel::isOp(std::string const &user) const
+bool Channel::isOp(Client const *client) const
 {
-	return (this->_operators.find(user) != this->_operators.end());
+	ChannelMember const *member = this->_findMember(client);
+	return (member && (member->flags & MEMBER_OP));
 }
-
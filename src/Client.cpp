@@ -12,9 +12,11 @@
 
 #include "../include/Client.hpp"
 
+static unsigned long g_next_client_id = 1;
+
 Client::Client(int client_socket, sockaddr_in client_addr) \
-	: _client_fd(client_socket), _client_addr(client_addr), \
-	_isRegistered(false), _hasPassword(false), _hasNick(false), _hasUser(false)
+	: _id(__sync_fetch_and_add(&g_next_client_id, 1)), _shard(NULL), _client_fd(client_socket), _client_addr(client_addr), _sendq_offset(0), \
+	_sendq_bytes(0), _watched_events(0), _flush_scheduled(false), _closing(false), _ping_sent_ms(0), _isRegistered(false), _hasPassword(false), _hasNick(false), _hasUser(false)
 {
 	//Converts IP address to string in a secure way
 	char ip_str[INET_ADDRSTRLEN];
@@ -23,10 +25,11 @@ Client::Client(int client_socket, sockaddr_in client_addr) \
 		this->_hostname = std::string(ip_str);
 	else
 		this->_hostname = "unknown";
+	this->_updatePrefix();
 	
 	logMessage("New client connected! FD= ", BLUE, itoa(client_socket), GREEN);
-	this->_lastActivity = time(NULL);
-	
+	this->_lastActivity = monotonicMs();
+	this->_timer.fd = client_socket;
 }
 
 Client::~Client()
@@ -35,12 +38,45 @@ Client::~Client()
 		close(this->_client_fd);
 }
 
+static ObjectPool<Client> g_client_pool;
+
+ObjectPool<Client> &Client::pool()
+{
+	return g_client_pool;
+}
+
+void *Client::operator new(size_t size)
+{
+	(void)size; // Always sizeof(Client), nothing derives from it
+	return g_client_pool.allocate();
+}
+
+void Client::operator delete(void *pointer)
+{
+	g_client_pool.release(pointer);
+}
+
+Shard *Client::getShard() const
+{
+	return this->_shard;
+}
+
+void Client::setShard(Shard *shard)
+{
+	this->_shard = shard;
+}
+
+unsigned long Client::getId() const
+{
+	return this->_id;
+}
+
 int Client::getFd() const
 {
 	return this->_client_fd;
 }
 
-std::string Client::getHostname() const
+std::string const &Client::getHostname() const
 {
 	return this->_hostname;
 }
@@ -50,29 +86,36 @@ sockaddr_in Client::getClientAddr() const
 	return this->_client_addr;
 }
 
-std::string Client::getNickname() const
+std::string const &Client::getNickname() const
 {
 	return this->_nickname;
 }
 
-std::string Client::getRealname() const
+std::string const &Client::getRealname() const
 {
 	return this->_realname;
 }
 
-std::string Client::getUsername() const
+std::string const &Client::getUsername() const
 {
 	return this->_username;
 }
 
-std::string Client::getPassword() const
+std::string const &Client::getPassword() const
 {
 	return this->_password;
 }
 
-std::string Client::getBuffer() const
+// Source of every message relayed on behalf of the client
+std::string const &Client::getPrefix() const
 {
-	return this->_buffer;
+	return this->_prefix;
+}
+
+void Client::_updatePrefix()
+{
+	this->_prefix.assign(":").append(this->_nickname).append("!") \
+		.append(this->_username).append("@").append(this->_hostname);
 }
 
 bool Client::isRegistered() const
@@ -80,47 +123,149 @@ bool Client::isRegistered() const
 	return (this->_isRegistered);
 }
 
-void Client::appendBuffer(const std::string &data)
+size_t Client::getBufferSpace() const
+{
+	return this->_input.space();
+}
+
+void Client::appendBuffer(const char *data, size_t length)
 {
 	// Prevent buffer overflow
-	if (this->_buffer.length() + data.length() > MAX_BUFFER_SIZE)
+	if (!this->_input.append(data, length))
 	{
 		logMessage("WARNING: ", YELLOW, \
 			"Buffer overflow prevented for client FD=" \
-			+ itoa(_client_fd), WHITE);
-		this->_buffer.clear(); //Cleans up buffer to avoid errors
-		return;
+			+ itoa(_client_fd), WHITE, WARN);
+		this->_input.clear(); //Cleans up buffer to avoid errors
 	}
-	
-	this->_buffer += data;
 }
 
-bool Client::isDataComplete() const
+void Client::cleanBuffer()
 {
-	return (this->_buffer.find("\r\n") != std::string::npos \
-			|| this->_buffer.find("\n") != std::string::npos);
+	this->_input.clear();
 }
 
-void Client::cleanBuffer()
+// Next complete line (terminator stripped, empty lines skipped).
+// The view is only valid until more data is appended.
+bool Client::getNextCompleteMessage(LineView &line)
 {
-	this->_buffer.clear();
+	return this->_input.nextLine(line);
 }
 
-std::string Client::getNextCompleteMessage()
+void Client::queueMessage(SharedMessage const &message)
 {
-	std::string message;
-	size_t pos = this->_buffer.find("\r\n");
+	if (message.empty())
+		return;
+	this->_sendq.push_back(message);
+	this->_sendq_bytes += message.length();
+}
+
+bool Client::hasPendingOutput() const
+{
+	return !this->_sendq.empty();
+}
+
+size_t Client::getSendQBytes() const
+{
+	return this->_sendq_bytes;
+}
 
-	if (pos == std::string::npos)
-		pos = this->_buffer.find("\n");
+// Writes as much of the queue as the socket accepts without blocking,
+// gathering up to FLUSH_IOV_MAX queued lines per writev().
+// Returns 1 if data is still pending, 0 if the queue was drained and
+// -1 on a fatal socket error. syscalls counts the writev() calls made.
+int Client::flushSendQueue(unsigned long &syscalls)
+{
+	struct iovec iov[FLUSH_IOV_MAX];
 
-	if (pos != std::string::npos)
+	while (!this->_sendq.empty())
 	{
-		message = this->_buffer.substr(0, pos);
-		this->_buffer.erase(0, pos + (this->_buffer[pos] == '\r' ? 2 : 1));
+		size_t count = 0;
+		size_t requested = 0;
+		for (; count < this->_sendq.size() && count < FLUSH_IOV_MAX; ++count)
+		{
+			SharedMessage const &line = this->_sendq.at(count);
+			size_t skip = (count == 0) ? this->_sendq_offset : 0;
+			iov[count].iov_base = const_cast<char *>(line.data() + skip);
+			iov[count].iov_len = line.length() - skip;
+			requested += iov[count].iov_len;
+		}
+
+		ssize_t sent = writev(this->_client_fd, iov, count);
+		syscalls++;
+		if (sent < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return 1;
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+
+		// Release every line that went out completely
+		size_t left = sent;
+		this->_sendq_bytes -= sent;
+		while (left > 0)
+		{
+			size_t remaining = this->_sendq.front().length() - this->_sendq_offset;
+			if (left < remaining)
+			{
+				this->_sendq_offset += left;
+				break;
+			}
+			left -= remaining;
+			this->_sendq.pop_front();
+			this->_sendq_offset = 0;
+		}
+		if (static_cast<size_t>(sent) < requested)
+			return 1; // Short write, the socket buffer is full
 	}
+	return 0;
+}
+
+bool Client::isFlushScheduled() const
+{
+	return this->_flush_scheduled;
+}
+
+void Client::setFlushScheduled(bool scheduled)
+{
+	this->_flush_scheduled = scheduled;
+}
+
+int Client::getWatchedEvents() const
+{
+	return this->_watched_events;
+}
+
+void Client::setWatchedEvents(int events)
+{
+	this->_watched_events = events;
+}
+
+void Client::setClosing(bool closing)
+{
+	this->_closing = closing;
+}
+
+bool Client::isClosing() const
+{
+	return (this->_closing);
+}
+
+void Client::setQuitReason(const std::string &reason)
+{
+	this->_quit_reason = reason;
+}
+
+std::string const &Client::getQuitReason() const
+{
+	return this->_quit_reason;
+}
 
-	return message;
+bool Client::hasQuitReason() const
+{
+	return !this->_quit_reason.empty();
 }
 
 void Client::checkRegistrationComplete()
@@ -134,7 +279,8 @@ void Client::checkRegistrationComplete()
 		this->_username = this->_nickname;
 		this->_realname = this->_nickname;
 		this->_hasUser = true;
-		logMessage("Auto-generated USER data for: ", CYAN, \
+		this->_updatePrefix();
+		LOG_DEBUG("Auto-generated USER data for: ", CYAN, \
 			this->_nickname, WHITE);
 	}
 	
@@ -145,12 +291,11 @@ void Client::checkRegistrationComplete()
 	if (!was_registered && this->_isRegistered)
 	{
 		logMessage("Client registration data complete! Nick: ", GREEN, \
-			this->_nickname + " User: " + this->_username + " Pass: " \
-			+ this->_password, BLUE);
+			this->_nickname + " User: " + this->_username, BLUE);
 	}
 	else if (!this->_isRegistered)
 	{
-		logMessage("Client registration incomplete - Nick: " \
+		LOG_DEBUG("Client registration incomplete - Nick: " \
 				+ std::string(this->_hasNick ? "OK" : "MISSING") \
 				+ " User: " + (this->_hasUser ? "OK" : "MISSING") \
 				+ " Pass: " + (this->_hasPassword ? "OK" : "MISSING"), \
@@ -158,22 +303,50 @@ void Client::checkRegistrationComplete()
 	}
 }
 
-void Client::joinChannel(const std::string &channelName)
+void Client::linkChannel(Channel *channel, size_t slot)
 {
-	this->_channels.insert(channelName);
+	ChannelLink link;
+	link.channel = channel;
+	link.slot = slot;
+	this->_channels.push_back(link);
 }
 
-void Client::leaveChannel(const std::string &channelName)
+void Client::unlinkChannel(Channel *channel)
 {
-	this->_channels.erase(channelName);
+	for (size_t i = 0; i < this->_channels.size(); i++)
+	{
+		if (this->_channels[i].channel == channel)
+		{
+			this->_channels[i] = this->_channels.back();
+			this->_channels.pop_back();
+			return;
+		}
+	}
 }
 
-bool Client::isInChannel(const std::string &channelName) const
+void Client::relinkChannel(Channel *channel, size_t slot)
 {
-	return (this->_channels.find(channelName) != this->_channels.end());
+	for (size_t i = 0; i < this->_channels.size(); i++)
+	{
+		if (this->_channels[i].channel == channel)
+		{
+			this->_channels[i].slot = slot;
+			return;
+		}
+	}
 }
 
-std::set<std::string> Client::getChannels() const
+// Slot in the channel member table, -1 when not a member.
+// A client is in a handful of channels, so this scan is short.
+int Client::getChannelSlot(Channel const *channel) const
+{
+	for (size_t i = 0; i < this->_channels.size(); i++)
+		if (this->_channels[i].channel == channel)
+			return static_cast<int>(this->_channels[i].slot);
+	return -1;
+}
+
+std::vector<ChannelLink> const &Client::getChannels() const
 {
 	return this->_channels;
 }
@@ -197,7 +370,22 @@ bool Client::isValidInput(const std::string &input) const
 	return true;
 }
 
-time_t Client::getLastActivity (void)
+unsigned long Client::getLastActivity (void) const
 {
 	return (this->_lastActivity);
 }
+
+TimerNode &Client::getTimer()
+{
+	return (this->_timer);
+}
+
+void Client::setPingSent(unsigned long now_ms)
+{
+	this->_ping_sent_ms = now_ms;
+}
+
+unsigned long Client::getPingSent() const
+{
+	return (this->_ping_sent_ms);
+}
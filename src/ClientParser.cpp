@@ -31,7 +31,7 @@ void Client::parsePassCommand(const std::string &line)
 		this->_password = password;
 		this->_hasPassword = !password.empty();
 		
-		logMessage("Password set for client FD=" + itoa(_client_fd) \
+		LOG_DEBUG("Password set for client FD=" + itoa(_client_fd) \
 				+ ": ", CYAN, (password.empty() ? "[EMPTY]" \
 				: this->_password), WHITE);
 
@@ -61,7 +61,7 @@ void Client::parseNickCommand(const std::string &line)
 			nickname = nickname.substr(0, space_pos);
 		
 		this->setNickname(nickname);
-		logMessage("Nickname parsed for client FD=" + itoa(_client_fd) \
+		LOG_DEBUG("Nickname parsed for client FD=" + itoa(_client_fd) \
 			+ ": ", CYAN, nickname, WHITE);
 	}
 }
@@ -99,7 +99,7 @@ void Client::parseUserCommand(const std::string &line)
 				this->setRealname(realname);
 			}
 
-			logMessage("User info parsed for client FD=" + itoa(_client_fd) \
+			LOG_DEBUG("User info parsed for client FD=" + itoa(_client_fd) \
 				+ ": ", CYAN, username, WHITE);
 		}
 	}
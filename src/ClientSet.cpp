@@ -28,6 +28,7 @@ void Client::setNickname(const std::string &nickname)
 
 	this->_nickname = formattedNick;
 	this->_hasNick = !formattedNick.empty();
+	this->_updatePrefix();
 	this->checkRegistrationComplete();
 }
 
@@ -35,6 +36,7 @@ void Client::setUsername(const std::string &username)
 {
 	this->_username = username;
 	this->_hasUser = !username.empty();
+	this->_updatePrefix();
 	this->checkRegistrationComplete();
 }
 
@@ -70,7 +72,7 @@ void Client::setNamesAndPass(std::string const &data)
 		}
 	}
 }
-void Client::setLastActivity (time_t now)
+void Client::setLastActivity (unsigned long now_ms)
 {
-	this->_lastActivity = now;
+	this->_lastActivity = now_ms;
 }
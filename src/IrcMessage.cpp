@@ -0,0 +1,128 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IrcMessage.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 15:48:03 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 15:48:03 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/IrcMessage.hpp"
+
+static const IrcToken g_empty_token = { "", 0 };
+
+IrcMessage::IrcMessage() : _param_count(0), _has_trailing(false)
+{
+	this->_prefix = g_empty_token;
+	this->_command = g_empty_token;
+}
+
+IrcMessage::IrcMessage(const char *line, size_t length) \
+	: _param_count(0), _has_trailing(false)
+{
+	this->parse(line, length);
+}
+
+IrcMessage::~IrcMessage()
+{
+}
+
+// Single left to right pass, returns false if there is no command
+bool IrcMessage::parse(const char *line, size_t length)
+{
+	const char *end = line + length;
+	const char *p = line;
+
+	this->_prefix = g_empty_token;
+	this->_command = g_empty_token;
+	this->_param_count = 0;
+	this->_has_trailing = false;
+
+	while (p < end && *p == ' ')
+		p++;
+
+	// Optional ":prefix"
+	if (p < end && *p == ':')
+	{
+		const char *start = ++p;
+		while (p < end && *p != ' ')
+			p++;
+		this->_prefix.data = start;
+		this->_prefix.length = p - start;
+		while (p < end && *p == ' ')
+			p++;
+	}
+
+	const char *start = p;
+	while (p < end && *p != ' ')
+		p++;
+	this->_command.data = start;
+	this->_command.length = p - start;
+
+	while (p < end)
+	{
+		while (p < end && *p == ' ')
+			p++;
+		if (p == end)
+			break;
+
+		IrcToken &param = this->_params[this->_param_count++];
+
+		// ":trailing" (or the last allowed slot) takes the rest of the line
+		if (*p == ':' || this->_param_count == IRC_MAX_PARAMS)
+		{
+			if (*p == ':')
+			{
+				p++;
+				this->_has_trailing = true;
+			}
+			param.data = p;
+			param.length = end - p;
+			break;
+		}
+
+		start = p;
+		while (p < end && *p != ' ')
+			p++;
+		param.data = start;
+		param.length = p - start;
+	}
+	return !this->_command.empty();
+}
+
+IrcToken const &IrcMessage::getPrefix() const
+{
+	return this->_prefix;
+}
+
+IrcToken const &IrcMessage::getCommand() const
+{
+	return this->_command;
+}
+
+size_t IrcMessage::paramCount() const
+{
+	return this->_param_count;
+}
+
+bool IrcMessage::hasTrailing() const
+{
+	return this->_has_trailing;
+}
+
+IrcToken const &IrcMessage::param(size_t index) const
+{
+	if (index >= this->_param_count)
+		return g_empty_token;
+	return this->_params[index];
+}
+
+std::string IrcMessage::getParam(size_t index, std::string const &fallback) const
+{
+	if (index >= this->_param_count)
+		return fallback;
+	return this->_params[index].str();
+}
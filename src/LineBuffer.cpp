@@ -0,0 +1,106 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LineBuffer.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 15:02:37 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 15:02:37 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/LineBuffer.hpp"
+
+#define LINE_BUFFER_MASK (LINE_BUFFER_SIZE - 1)
+
+LineBuffer::LineBuffer() : _head(0), _size(0), _scanned(0)
+{
+}
+
+LineBuffer::~LineBuffer()
+{
+}
+
+// Copies data after the unread bytes, in at most two chunks.
+// Returns false (and stores nothing) if it does not fit.
+bool LineBuffer::append(const char *data, size_t length)
+{
+	if (length > this->space())
+		return false;
+
+	size_t tail = (this->_head + this->_size) & LINE_BUFFER_MASK;
+	size_t first = LINE_BUFFER_SIZE - tail;
+	if (first > length)
+		first = length;
+
+	memcpy(this->_data + tail, data, first);
+	memcpy(this->_data, data + first, length - first);
+	this->_size += length;
+	return true;
+}
+
+// Yields the next complete, non empty line and consumes it.
+// Returns false when only a partial line (or nothing) is left.
+bool LineBuffer::nextLine(LineView &line)
+{
+	while (true)
+	{
+		// Resume the '\n' search where the previous call stopped
+		const char *newline = NULL;
+		while (!newline && this->_scanned < this->_size)
+		{
+			size_t pos = (this->_head + this->_scanned) & LINE_BUFFER_MASK;
+			size_t chunk = this->_size - this->_scanned;
+			if (chunk > LINE_BUFFER_SIZE - pos)
+				chunk = LINE_BUFFER_SIZE - pos;
+
+			newline = static_cast<const char *>(memchr(this->_data + pos, '\n', chunk));
+			this->_scanned += newline ? (newline - (this->_data + pos)) : chunk;
+		}
+		if (!newline)
+			return false;
+
+		size_t start = this->_head;
+		size_t length = this->_scanned;
+
+		// Consume the line and its '\n'
+		this->_head = (this->_head + length + 1) & LINE_BUFFER_MASK;
+		this->_size -= length + 1;
+		this->_scanned = 0;
+
+		if (length > 0 && this->_data[(start + length - 1) & LINE_BUFFER_MASK] == '\r')
+			length--;
+		if (length == 0)
+			continue; // Empty lines are ignored
+
+		if (start + length <= LINE_BUFFER_SIZE)
+			line.data = this->_data + start;
+		else
+		{
+			size_t first = LINE_BUFFER_SIZE - start;
+			memcpy(this->_wrapped, this->_data + start, first);
+			memcpy(this->_wrapped + first, this->_data, length - first);
+			line.data = this->_wrapped;
+		}
+		line.length = length;
+		return true;
+	}
+}
+
+void LineBuffer::clear()
+{
+	this->_head = 0;
+	this->_size = 0;
+	this->_scanned = 0;
+}
+
+size_t LineBuffer::size() const
+{
+	return this->_size;
+}
+
+size_t LineBuffer::space() const
+{
+	return LINE_BUFFER_SIZE - this->_size;
+}
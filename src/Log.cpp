@@ -0,0 +1,263 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Log.cpp                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 18:05:12 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 18:05:12 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Log.hpp"
+#include "../include/Utils.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+
+#define LOG_MASK		(LOG_RING_SLOTS - 1)
+#define LOG_BATCH_MAX	65536	// Bytes gathered per write() by the writer
+#define LOG_IDLE_MAX_US	32000	// Longest writer nap while the ring is empty
+
+// A slot is free for position p when sequence == p, and holds the line of
+// position p once sequence == p + 1 (bounded multi producer queue)
+struct LogSlot
+{
+	volatile unsigned long sequence;
+	int type;
+	size_t length;
+	char text[LOG_LINE_MAX];
+};
+
+static LogSlot g_slots[LOG_RING_SLOTS];
+static volatile unsigned long g_tail = 0;	// Next position claimed by a producer
+static unsigned long g_head = 0;			// Next position read, writer thread only
+static volatile unsigned long g_dropped = 0;
+static volatile int g_running = 0;
+static int g_level = LOG;
+static pthread_t g_writer;
+
+// Atomic read, also a barrier for what the other side wrote before it
+static unsigned long loadValue(volatile unsigned long *value)
+{
+	return __sync_fetch_and_add(value, 0);
+}
+
+static size_t appendText(char *out, size_t used, size_t limit, \
+	std::string const &text)
+{
+	size_t length = std::min(text.size(), limit - used);
+	memcpy(out + used, text.data(), length);
+	return used + length;
+}
+
+// Same layout the server always printed, truncated to one slot
+static size_t formatLine(char *out, std::string const &msg, \
+	std::string const &msg_color, std::string const &args, \
+	std::string const &args_color)
+{
+	static const char tail[] = RESET "\n";
+	size_t limit = LOG_LINE_MAX - (sizeof(tail) - 1);
+	size_t used = 0;
+
+	used = appendText(out, used, limit, msg_color);
+	used = appendText(out, used, limit, msg);
+	used = appendText(out, used, limit, RESET);
+	used = appendText(out, used, limit, args_color);
+	used = appendText(out, used, limit, args);
+	memcpy(out + used, tail, sizeof(tail) - 1);
+	return used + sizeof(tail) - 1;
+}
+
+static void writeAll(int fd, const char *data, size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t written = write(fd, data, length);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return; // Nowhere left to complain to
+		data += written;
+		length -= written;
+	}
+}
+
+// Producers never wait: a full ring means the line is dropped
+static bool enqueue(int type, std::string const &msg, \
+	std::string const &msg_color, std::string const &args, \
+	std::string const &args_color)
+{
+	unsigned long position = loadValue(&g_tail);
+	LogSlot *slot;
+
+	for (;;)
+	{
+		slot = &g_slots[position & LOG_MASK];
+		long diff = static_cast<long>(loadValue(&slot->sequence) - position);
+		if (diff == 0 \
+			&& __sync_bool_compare_and_swap(&g_tail, position, position + 1))
+			break;
+		if (diff < 0)
+			return false; // The writer has not freed this slot yet
+		position = loadValue(&g_tail);
+	}
+
+	slot->type = type;
+	slot->length = formatLine(slot->text, msg, msg_color, args, args_color);
+	// Full barrier: the text is visible before the slot is published
+	__sync_bool_compare_and_swap(&slot->sequence, position, position + 1);
+	return true;
+}
+
+// Moves published lines into the batches, returns how many were taken
+static size_t drain(std::string &out, std::string &err)
+{
+	size_t taken = 0;
+
+	while (out.size() + err.size() < LOG_BATCH_MAX)
+	{
+		LogSlot *slot = &g_slots[g_head & LOG_MASK];
+		if (loadValue(&slot->sequence) != g_head + 1)
+			break;
+		(slot->type == ERR ? err : out).append(slot->text, slot->length);
+		__sync_bool_compare_and_swap(&slot->sequence, g_head + 1, \
+			g_head + LOG_RING_SLOTS);
+		g_head++;
+		taken++;
+	}
+	return taken;
+}
+
+static void *writerMain(void *)
+{
+	std::string out;
+	std::string err;
+	unsigned long reported = 0;
+	long idle_us = 1000;
+
+	out.reserve(LOG_BATCH_MAX + LOG_LINE_MAX);
+	err.reserve(LOG_BATCH_MAX + LOG_LINE_MAX);
+	for (;;)
+	{
+		// Read before draining so every line queued before logStop() is kept
+		bool stopping = !__sync_fetch_and_add(&g_running, 0);
+		size_t taken = drain(out, err);
+
+		unsigned long dropped = __sync_fetch_and_add(&g_dropped, 0);
+		if (dropped != reported)
+		{
+			char note[LOG_LINE_MAX];
+			size_t length = formatLine(note, "WARNING: ", YELLOW, \
+				"log ring full, dropped " + itoa(dropped - reported) \
+				+ " lines", WHITE);
+			out.append(note, length);
+			reported = dropped;
+		}
+		writeAll(STDOUT_FILENO, out.data(), out.size());
+		writeAll(STDERR_FILENO, err.data(), err.size());
+		out.clear();
+		err.clear();
+
+		if (taken > 0)
+		{
+			idle_us = 1000;
+			continue;
+		}
+		if (stopping)
+			break;
+
+		// Nothing queued: nap, longer the longer the server stays quiet
+		struct timespec nap;
+		nap.tv_sec = 0;
+		nap.tv_nsec = idle_us * 1000;
+		nanosleep(&nap, NULL);
+		if (idle_us < LOG_IDLE_MAX_US)
+			idle_us *= 2;
+	}
+	return NULL;
+}
+
+void logMessage(std::string const &msg, std::string const &msg_color, \
+	std::string const &args, std::string const &args_color, int type)
+{
+	if (type < g_level)
+		return;
+
+	if (__sync_fetch_and_add(&g_running, 0))
+	{
+		if (!enqueue(type, msg, msg_color, args, args_color))
+			__sync_fetch_and_add(&g_dropped, 1);
+		return;
+	}
+
+	char line[LOG_LINE_MAX];
+	size_t length = formatLine(line, msg, msg_color, args, args_color);
+	writeAll(type == ERR ? STDERR_FILENO : STDOUT_FILENO, line, length);
+}
+
+bool logStart(void)
+{
+	if (__sync_fetch_and_add(&g_running, 0))
+		return true;
+
+	for (unsigned long i = 0; i < LOG_RING_SLOTS; i++)
+		g_slots[i].sequence = i;
+	g_tail = 0;
+	g_head = 0;
+	__sync_lock_test_and_set(&g_running, 1);
+
+	// Signals stay with the threads that handle them
+	sigset_t blocked;
+	sigset_t previous;
+	sigfillset(&blocked);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	int status = pthread_create(&g_writer, NULL, writerMain, NULL);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+	if (status != 0)
+	{
+		__sync_lock_release(&g_running);
+		return false;
+	}
+	return true;
+}
+
+// Writes out everything still queued, then logging is synchronous again
+void logStop(void)
+{
+	if (!__sync_fetch_and_add(&g_running, 0))
+		return;
+	__sync_lock_release(&g_running);
+	pthread_join(g_writer, NULL);
+}
+
+void logSetLevel(int level)
+{
+	g_level = level;
+}
+
+bool logParseLevel(std::string const &name, int &level)
+{
+	static const char *names[] = { "debug", "info", "warn", "error" };
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (name == names[i])
+		{
+			level = i; // Same order as DBG, LOG, WARN, ERR
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned long logDropped(void)
+{
+	return __sync_fetch_and_add(&g_dropped, 0);
+}
@@ -0,0 +1,31 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reactor.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 10:04:37 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 10:04:37 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Reactor.hpp"
+#include "../include/Utils.hpp"
+
+Reactor::~Reactor()
+{
+}
+
+Reactor *Reactor::create(void)
+{
+#if defined(__linux__) && !defined(IRC_USE_POLL)
+	EpollReactor *epoll_reactor = new EpollReactor();
+	if (epoll_reactor->isValid())
+		return epoll_reactor;
+	delete epoll_reactor;
+	logMessage("WARNING: ", YELLOW, \
+		"epoll unavailable, falling back to poll()", WHITE, WARN);
+#endif
+	return new PollReactor();
+}
@@ -0,0 +1,105 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReactorEpoll.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 10:11:45 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 10:11:45 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Reactor.hpp"
+
+#ifdef __linux__
+
+#include <unistd.h>
+#include <cstring>
+
+EpollReactor::EpollReactor()
+{
+	this->_epoll_fd = epoll_create(REACTOR_MAX_EVENTS);
+	memset(this->_events, 0, sizeof(this->_events));
+}
+
+EpollReactor::~EpollReactor()
+{
+	if (this->_epoll_fd >= 0)
+		close(this->_epoll_fd);
+}
+
+bool EpollReactor::isValid() const
+{
+	return (this->_epoll_fd >= 0);
+}
+
+unsigned int EpollReactor::_toEpoll(int events)
+{
+	unsigned int epoll_events = 0;
+
+	if (events & IO_READ)
+		epoll_events |= EPOLLIN;
+	if (events & IO_WRITE)
+		epoll_events |= EPOLLOUT;
+	if (events & IO_EDGE)
+		epoll_events |= EPOLLET;
+	return epoll_events;
+}
+
+bool EpollReactor::add(int fd, int events)
+{
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = _toEpoll(events);
+	event.data.fd = fd;
+	return (epoll_ctl(this->_epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0);
+}
+
+bool EpollReactor::modify(int fd, int events)
+{
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = _toEpoll(events);
+	event.data.fd = fd;
+	return (epoll_ctl(this->_epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0);
+}
+
+void EpollReactor::remove(int fd)
+{
+	// Kernels older than 2.6.9 require a non-NULL event for EPOLL_CTL_DEL
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	epoll_ctl(this->_epoll_fd, EPOLL_CTL_DEL, fd, &event);
+}
+
+int EpollReactor::wait(std::vector<ReactorEvent> &ready, int timeout_ms)
+{
+	ready.clear();
+	int count = epoll_wait(this->_epoll_fd, this->_events, \
+		REACTOR_MAX_EVENTS, timeout_ms);
+	if (count <= 0)
+		return count;
+
+	for (int i = 0; i < count; i++)
+	{
+		ReactorEvent event;
+		event.fd = this->_events[i].data.fd;
+		event.events = 0;
+		if (this->_events[i].events & EPOLLIN)
+			event.events |= IO_READ;
+		if (this->_events[i].events & EPOLLOUT)
+			event.events |= IO_WRITE;
+		if (this->_events[i].events & (EPOLLHUP | EPOLLERR))
+			event.events |= IO_HANGUP;
+		ready.push_back(event);
+	}
+	return count;
+}
+
+const char *EpollReactor::getName() const
+{
+	return "epoll";
+}
+
+#endif
@@ -0,0 +1,92 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReactorPoll.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 10:06:02 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 10:06:02 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Reactor.hpp"
+
+PollReactor::PollReactor()
+{
+}
+
+PollReactor::~PollReactor()
+{
+}
+
+short PollReactor::_toPoll(int events)
+{
+	short poll_events = 0;
+
+	if (events & IO_READ)
+		poll_events |= POLLIN;
+	if (events & IO_WRITE)
+		poll_events |= POLLOUT;
+	return poll_events;
+}
+
+bool PollReactor::add(int fd, int events)
+{
+	struct pollfd entry;
+	entry.fd = fd;
+	entry.events = _toPoll(events);
+	entry.revents = 0;
+	return this->_poll_fds.insert(fd, entry);
+}
+
+bool PollReactor::modify(int fd, int events)
+{
+	struct pollfd *entry = this->_poll_fds.find(fd);
+	if (!entry)
+		return false;
+	entry->events = _toPoll(events);
+	return true;
+}
+
+void PollReactor::remove(int fd)
+{
+	this->_poll_fds.erase(fd);
+}
+
+int PollReactor::wait(std::vector<ReactorEvent> &ready, int timeout_ms)
+{
+	ready.clear();
+	if (this->_poll_fds.empty())
+		return poll(NULL, 0, timeout_ms);
+
+	int poll_count = poll(this->_poll_fds.data(), this->_poll_fds.size(), \
+		timeout_ms);
+	if (poll_count <= 0)
+		return poll_count;
+
+	for (size_t i = 0; i < this->_poll_fds.size() \
+		&& static_cast<int>(ready.size()) < poll_count; i++)
+	{
+		short revents = this->_poll_fds.at(i).revents;
+		if (!revents)
+			continue;
+
+		ReactorEvent event;
+		event.fd = this->_poll_fds.at(i).fd;
+		event.events = 0;
+		if (revents & POLLIN)
+			event.events |= IO_READ;
+		if (revents & POLLOUT)
+			event.events |= IO_WRITE;
+		if (revents & (POLLHUP | POLLERR | POLLNVAL))
+			event.events |= IO_HANGUP;
+		ready.push_back(event);
+	}
+	return static_cast<int>(ready.size());
+}
+
+const char *PollReactor::getName() const
+{
+	return "poll";
+}
@@ -0,0 +1,140 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reply.cpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 21:24:37 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 21:24:37 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Reply.hpp"
+
+#include <cstring>
+
+#define REPLY_TEXT_MAX	(MAX_MESSAGE_LENGTH - 2)	// Room left for the CRLF
+
+Reply::Reply() : _length(0), _truncated(false)
+{
+	this->_data[0] = '\r';
+	this->_data[1] = '\n';
+}
+
+void Reply::_append(const char *text, size_t length)
+{
+	if (length > REPLY_TEXT_MAX - this->_length)
+	{
+		length = REPLY_TEXT_MAX - this->_length;
+		this->_truncated = true;
+	}
+	memcpy(this->_data + this->_length, text, length);
+	this->_length += length;
+	this->_data[this->_length] = '\r';
+	this->_data[this->_length + 1] = '\n';
+}
+
+// ":server 001 nick", the target is "*" until the client has a nick
+Reply &Reply::numeric(std::string const &server, int code, \
+	std::string const &target)
+{
+	char digits[4];
+
+	digits[0] = '0' + (code / 100) % 10;
+	digits[1] = '0' + (code / 10) % 10;
+	digits[2] = '0' + code % 10;
+	digits[3] = ' ';
+	this->_append(":", 1);
+	this->_append(server.data(), server.size());
+	this->_append(" ", 1);
+	this->_append(digits, sizeof(digits));
+	if (target.empty())
+		this->_append("*", 1);
+	else
+		this->_append(target.data(), target.size());
+	return *this;
+}
+
+Reply &Reply::source(std::string const &prefix)
+{
+	this->_append(prefix.data(), prefix.size());
+	return *this;
+}
+
+Reply &Reply::text(std::string const &text)
+{
+	this->_append(text.data(), text.size());
+	return *this;
+}
+
+Reply &Reply::text(const char *text)
+{
+	this->_append(text, strlen(text));
+	return *this;
+}
+
+Reply &Reply::word(std::string const &word)
+{
+	this->_append(" ", 1);
+	this->_append(word.data(), word.size());
+	return *this;
+}
+
+Reply &Reply::word(const char *word)
+{
+	this->_append(" ", 1);
+	this->_append(word, strlen(word));
+	return *this;
+}
+
+Reply &Reply::number(unsigned long value)
+{
+	char digits[24];
+	size_t start = sizeof(digits);
+
+	do
+	{
+		digits[--start] = '0' + value % 10;
+		value /= 10;
+	} while (value > 0);
+	digits[--start] = ' ';
+	this->_append(digits + start, sizeof(digits) - start);
+	return *this;
+}
+
+Reply &Reply::channel(std::string const &name)
+{
+	this->_append(" #", 2);
+	this->_append(name.data(), name.size());
+	return *this;
+}
+
+Reply &Reply::trailing(std::string const &text)
+{
+	this->_append(" :", 2);
+	this->_append(text.data(), text.size());
+	return *this;
+}
+
+Reply &Reply::trailing(const char *text)
+{
+	this->_append(" :", 2);
+	this->_append(text, strlen(text));
+	return *this;
+}
+
+const char *Reply::data() const
+{
+	return this->_data;
+}
+
+size_t Reply::length() const
+{
+	return this->_length + 2;
+}
+
+bool Reply::truncated() const
+{
+	return this->_truncated;
+}
@@ -12,19 +12,32 @@
 
 #include "../include/Server.hpp"
 
-Server::Server(int port, std::string password): \
-		_port(port), _password(password), _server_fd(-1)
+ServerConfig::ServerConfig() : sendq_max(DEFAULT_SENDQ_MAX), \
+		sendq_total_max(DEFAULT_SENDQ_TOTAL_MAX), threads(1), \
+		listen_backlog(DEFAULT_LISTEN_BACKLOG), \
+		pool_clients(DEFAULT_POOL_CLIENTS), pool_channels(DEFAULT_POOL_CHANNELS), \
+		ping_interval(DEFAULT_PING_INTERVAL), ping_timeout(DEFAULT_PING_TIMEOUT), \
+		registration_timeout(DEFAULT_REGISTRATION_TIMEOUT)
+{
+}
+
+Server::Server(int port, std::string password, ServerConfig const &config): \
+		_port(port), _password(password), _config(config), \
+		_command_stats(commandCount()), _stopping(0), _disconnect_request(0)
 {
 	this->_server_name = "ircserv";
+	pthread_mutex_init(&this->_world_lock, NULL);
 }
 
 Server::~Server()
 {	
-	if(this->_server_fd > 0)
-		close(this->_server_fd);
+	for (size_t i = 0; i < this->_shards.size(); i++)
+		delete this->_shards[i];
+	SharedMessage::releaseCache();
+	pthread_mutex_destroy(&this->_world_lock);
 }
 
-int Server::_createSocket()
+int Server::_createSocket(bool reuse_port)
 {
 	int listen_socket = socket(AF_INET, SOCK_STREAM, 0);
 
@@ -43,28 +56,41 @@ int Server::_createSocket()
 		return -1;
 	}
 
-	this->_server_fd = listen_socket;
-
 	int opt = 1;
-	if (setsockopt(this->_server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
+	if (setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
 	{
 		logMessage("ERROR: ", RED, \
 			"Failed to set socket options!", YELLOW, ERR);
+		close(listen_socket);
 		return (-1);
 	}
+
+	// Every shard binds the same port, the kernel spreads the connections
+	if (reuse_port)
+	{
+#ifdef SO_REUSEPORT
+		if (setsockopt(listen_socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+#endif
+		{
+			logMessage("ERROR: ", RED, \
+				"SO_REUSEPORT is not available!", YELLOW, ERR);
+			close(listen_socket);
+			return (-1);
+		}
+	}
 	
 	logMessage("Server socket created successfully!", BLUE, "", RESET);
-	return (this->_server_fd);
+	return (listen_socket);
 }
 
-int Server::_bindSocket(void)
+int Server::_bindSocket(int listen_socket)
 {
 	memset(&this->_server_addr, 0, sizeof(this->_server_addr));
 	this->_server_addr.sin_family = AF_INET;
 	this->_server_addr.sin_port = htons(this->_port);
 	this->_server_addr.sin_addr.s_addr = INADDR_ANY;
 
-	if(bind(this->_server_fd, (struct sockaddr*)&this->_server_addr, sizeof(this->_server_addr)) == -1)
+	if(bind(listen_socket, (struct sockaddr*)&this->_server_addr, sizeof(this->_server_addr)) == -1)
 	{
 		logMessage("ERROR: ", RED, "Can't bind to IP/port!", YELLOW, ERR);
 		return -1;
@@ -73,9 +99,9 @@ int Server::_bindSocket(void)
 	return (0);
 }
 
-int Server::_listenSocket()
+int Server::_listenSocket(int listen_socket)
 {
-	if(listen(this->_server_fd, SOMAXCONN) == -1)
+	if(listen(listen_socket, static_cast<int>(this->_config.listen_backlog)) == -1)
 	{
 		logMessage("ERROR: ", RED, "Can't listen!", YELLOW, ERR);
 		return -1;
@@ -87,81 +113,48 @@ int Server::_listenSocket()
 	return (0);
 }
 
-bool Server::serverInit()
+bool Server::_initShard(Shard *shard)
 {
-	if(this->_createSocket() == -1 ||
-			this->_bindSocket() == -1 ||
-			this->_listenSocket() == -1)
+	shard->listen_fd = this->_createSocket(this->_config.threads > 1);
+	if (shard->listen_fd == -1 \
+			|| this->_bindSocket(shard->listen_fd) == -1 \
+			|| this->_listenSocket(shard->listen_fd) == -1)
 		return (false);
-	
-	// Poll setup for server socket
-	struct pollfd server_pollfd;
-	server_pollfd.fd = this->_server_fd;
-	server_pollfd.events = POLLIN;
-	server_pollfd.revents = 0;
-	this->_poll_fds.push_back(server_pollfd);
 
+	// Readiness backend setup for the listener and the mailbox wake up
+	shard->reactor = Reactor::create();
+	if (!shard->initWakeup() \
+		|| !shard->reactor->add(shard->listen_fd, IO_READ) \
+		|| !shard->reactor->add(shard->getWakeFd(), IO_READ))
+	{
+		logMessage("ERROR: ", RED, "Failed to watch server socket!", \
+			YELLOW, ERR);
+		return (false);
+	}
 	return (true);
 }
 
-void Server::run()
+bool Server::serverInit()
 {
-	while(true)
+	Client::pool().reserve(this->_config.pool_clients);
+	Channel::pool().reserve(this->_config.pool_channels);
+
+	for (size_t i = 0; i < this->_config.threads; i++)
 	{
-		time_t now = time(NULL); // Time in seconds
-		int poll_count = poll(&this->_poll_fds[0], \
-							this->_poll_fds.size(), 5000);
-		if (poll_count == -1)
-		{
-			logMessage("ERROR: ", RED, "Poll failed!", YELLOW, ERR);
-			break;
-		}
-		if(poll_count == 0 && this->_poll_fds.size() > 1)
-		{
-			for(size_t i = 1; i < this->_poll_fds.size(); i++)
-			{
-				Client *client = this->getClient(this->_poll_fds[i].fd);
-				
-				// 10 minutes idle is automatically disconected
-				if(now - client->getLastActivity() > 600)
-					this->quitServer("QUIT", client->getFd(), "Idle");
-			}
-		}
-		size_t poll_size = this->_poll_fds.size();
-		for (size_t i = 0; i < poll_size; i++)
-		{
-			if (i >= this->_poll_fds.size())
-				break;
-			if(this->_poll_fds[i].revents & POLLIN)
-			{
-				if(this->_poll_fds[i].fd == this->_server_fd)
-				{
-					this->_acceptNewClient();
-				}
-				else
-				{
-					this->_handleClientData(this->_poll_fds[i].fd);
-					if(i >= this->_poll_fds.size())
-						break;
-				}
-			}
-			else if(this->_poll_fds[i].revents & (POLLHUP | POLLERR))
-			{
-				//Client disconnected by socket error
-				if(this->_poll_fds[i].fd != this->_server_fd)
-				{
-					this->_removeClient(this->_poll_fds[i].fd);
-					poll_size = this->_poll_fds.size(); //Update size;
-					i--; // Adjust index to avoid jumping over elements
-				}
-			}
-		}
+		this->_shards.push_back(new Shard(this, static_cast<int>(i)));
+		if (!this->_initShard(this->_shards.back()))
+			return (false);
 	}
+	logMessage("Event loop backend: ", BLUE, \
+		std::string(this->_shards[0]->reactor->getName()) + " x " \
+		+ itoa(this->_shards.size()), GREEN);
+
+	return (true);
 }
 
 int Server::getServerFd(void)
 {
-	return this->_server_fd;
+	return this->_shards.empty() ? -1 : this->_shards[0]->listen_fd;
 }
 
 std::string Server::getServerName(void) const
@@ -169,29 +162,51 @@ std::string Server::getServerName(void) const
 	return (this->_server_name);
 }
 
-void Server::_sendErrorReply(int client_fd, int code, const std::string &message)
+// ":server code nick :message"
+void Server::_sendErrorReply(int client_fd, int code, const char *message)
 {
 	Client *client = getClient(client_fd);
 	if (!client)
 		return;
 
-	std::ostringstream oss;
-	oss << ":" << _server_name << " " << std::setfill('0') << std::setw(3) << code << " " << (client->getNickname().empty() ? "*" : client->getNickname()) << " :" << message << "\r\n";
+	this->sendToClient(client, Reply().numeric(this->_server_name, code, \
+		client->getNickname()).trailing(message));
+}
+
+// ":server code nick param :message", param is a nick, command or target
+void Server::_sendErrorReply(int client_fd, int code, std::string const &param, \
+	const char *message)
+{
+	Client *client = getClient(client_fd);
+	if (!client)
+		return;
 
-	std::string reply = oss.str();
-	if (send(client_fd, reply.c_str(), reply.length(), 0) == -1)
-		logMessage("ERROR: ", RED, "Failed to send error reply!", YELLOW, ERR);
+	this->sendToClient(client, Reply().numeric(this->_server_name, code, \
+		client->getNickname()).word(param).trailing(message));
 }
 
-std::vector<std::string> Server::_splitMessage(const std::string &message)
+// ":server code nick #channel :message", channel is the name without '#'
+void Server::_sendChannelError(int client_fd, int code, \
+	std::string const &channel, const char *message)
 {
-	std::vector<std::string> result;
-	std::istringstream iss(message);
-	std::string token;
+	Client *client = getClient(client_fd);
+	if (!client)
+		return;
 
-	while (iss >> token)
-		result.push_back(token);
-	return result;
+	this->sendToClient(client, Reply().numeric(this->_server_name, code, \
+		client->getNickname()).channel(channel).trailing(message));
+}
+
+// ":server code nick othernick #channel :message"
+void Server::_sendChannelError(int client_fd, int code, std::string const &nick, \
+	std::string const &channel, const char *message)
+{
+	Client *client = getClient(client_fd);
+	if (!client)
+		return;
+
+	this->sendToClient(client, Reply().numeric(this->_server_name, code, \
+		client->getNickname()).word(nick).channel(channel).trailing(message));
 }
 
 void Server::_welcomeMessage(Client* client)
@@ -237,28 +252,33 @@ void Server::_welcomeMessage(Client* client)
 
 	while(getline(welcome, line, '\n'))
 	{
-		std::string msg = ":" + client->getHostname() \
-		+ " 001 " + client->getNickname() + " :" + line + "\r\n";
-		send(client->getFd(), msg.c_str(), msg.length(), 0);
+		this->sendToClient(client, Reply().numeric(client->getHostname(), \
+			RPL_WELCOME, client->getNickname()).trailing(line));
 	}
 }
 
 void Server::cleanUp()
 {
-	// Free all clients
-	for (std::map<int, Client*>::iterator it = this->_clients.begin(); \
-		it != this->_clients.end(); ++it) {
-		delete it->second; //Deletes the second on the ::map, which is Client*
+	// Free all clients, the shard threads are no longer running
+	for (size_t i = 0; i < this->_shards.size(); i++)
+	{
+		Shard *shard = this->_shards[i];
+		for (size_t j = 0; j < shard->clients.size(); j++)
+		{
+			shard->reactor->remove(shard->clients.fdAt(j));
+			shard->timers.cancel(&shard->clients.at(j)->getTimer());
+			delete shard->clients.at(j);
+		}
+		shard->clients.clear();
+		shard->flush_queue.clear();
+		shard->pending_quits.clear();
 	}
-	this->_clients.clear();
+	this->_nicks.clear();
 
 	//Free all channels
-	for (std::map<std::string, Channel*>::iterator it = \
-		this->_channels.begin(); it != this->_channels.end(); ++it) {
-		delete it->second;
-	}
+	std::vector<Channel*> channels;
+	this->_channels.values(channels);
+	for (size_t i = 0; i < channels.size(); i++)
+		delete channels[i];
 	this->_channels.clear();
-
-	std::vector<pollfd>().swap(this->_poll_fds);
-	// std::vector<pollfd>() creates a temporary, empty vector and .swap(this->_poll_fds) swaps the contents of the empty vector with this->_poll_fds. The old data is now in the temporary vector, which is immediately destroyed, freeing its memory.
 }
@@ -14,36 +14,28 @@
 
 Channel *Server::getChannelByName(std::string const &name)
 {
-	std::map<std::string, Channel*>::iterator channel_it;
-
-	for (channel_it = this->_channels.begin(); \
-		channel_it != this->_channels.end(); channel_it++)
-	{
-		Channel *temp = channel_it->second;
-		if(temp->getName() == name)
-			return (temp);
-	}
-	return (NULL);
+	Channel **channel = this->_channels.find(name);
+	return (channel ? *channel : NULL);
 }
 
-void Server::joinChannel(std::string const &data, int client_fd)
+void Server::_destroyChannel(Channel *channel)
 {
-	std::vector<std::string> tokens = _splitMessage(data);
+	std::string name = channel->getName();
 
-	if (tokens.size() < 2)
-	{
-		this->_sendErrorReply(client_fd, ERR_NEEDMOREPARAMS, \
-			"JOIN :Not enough parameters");
-		return;
-	}
+	this->_channels.erase(name);
+	delete channel;
+	logMessage("Empty channel removed: ", YELLOW, name, RED);
+}
 
-	std::string channelName = tokens[1];
-	std::string channelPassword = (tokens.size() > 2) ? tokens[2] : "";
+void Server::joinChannel(IrcMessage const &msg, int client_fd)
+{
+	std::string channelName = msg.getParam(0);
+	std::string channelPassword = msg.getParam(1);
 
 	if (channelName[0] != '#')
 	{
-		this->_sendErrorReply(client_fd, ERR_NOSUCHCHANNEL, channelName \
-			+ " :No such channel");
+		this->_sendErrorReply(client_fd, ERR_NOSUCHCHANNEL, channelName, \
+			"No such channel");
 		return;
 	}
 
@@ -51,8 +43,8 @@ void Server::joinChannel(std::string const &data, int client_fd)
 	
 	if (!_isValidChannelName(channelName))
 	{
-		this->_sendErrorReply(client_fd, ERR_NOSUCHCHANNEL, "#" \
-			+ channelName + " :No such channel");
+		this->_sendChannelError(client_fd, ERR_NOSUCHCHANNEL, channelName, \
+			"No such channel");
 		return;
 	}
 
@@ -60,197 +52,152 @@ void Server::joinChannel(std::string const &data, int client_fd)
 	if (!client)
 		return;
 
-	// Verify if the client is already on channel
-	if (client->isInChannel("#" + channelName))
-		return;
-
 	Channel *channel = this->getChannelByName(channelName);
 
 	if (!channel)
 	{
 		// Create new channel
 		channel = new Channel(channelName, channelPassword);
-		this->_channels[channelName] = channel;
+		this->_channels.insert(channelName, channel);
 	}
+	channelName = channel->getName(); // Spelling of the channel creator
+
+	// Verify if the client is already on channel
+	if (channel->hasUser(client))
+		return;
 
 	// Verify if client can join channel
-	if (!channel->canUserJoin(client->getNickname(), channelPassword))
+	if (!channel->canUserJoin(client, channelPassword))
 	{
 		// Send error based on reason of not joining
-		if (channel->hasMode(MODE_INVITE_ONLY) && !channel->isInvited(client->getNickname()))
-			this->_sendErrorReply(client_fd, ERR_INVITEONLYCHAN, "#" \
-				+ channelName + " :Cannot join channel (+i)");
+		if (channel->hasMode(MODE_INVITE_ONLY) && !channel->isInvited(client))
+			this->_sendChannelError(client_fd, ERR_INVITEONLYCHAN, channelName, \
+				"Cannot join channel (+i)");
 		else if (channel->hasMode(MODE_LIMIT) && channel->getUserLimit() > 0 \
 				&& channel->getUserCount() >= channel->getUserLimit())
-			this->_sendErrorReply(client_fd, ERR_CHANNELISFULL, "#" \
-				+ channelName + " :Cannot join channel (+l)");
+			this->_sendChannelError(client_fd, ERR_CHANNELISFULL, channelName, \
+				"Cannot join channel (+l)");
 		else if (channel->hasMode(MODE_KEY) && !channel->getKey().empty() \
 				&& channelPassword != channel->getKey())
-			this->_sendErrorReply(client_fd, ERR_BADCHANNELKEY, "#" \
-				+ channelName + " :Cannot join channel (+k)");
+			this->_sendChannelError(client_fd, ERR_BADCHANNELKEY, channelName, \
+				"Cannot join channel (+k)");
 		else
-			this->_sendErrorReply(client_fd, ERR_NOSUCHCHANNEL, "#" \
-			+ channelName + " :Cannot join channel");
+			this->_sendChannelError(client_fd, ERR_NOSUCHCHANNEL, channelName, \
+			"Cannot join channel");
 		return;
 	}
 
 	// Add user to channel
-	channel->addUser(client->getNickname(), channelPassword);
-	client->joinChannel("#" + channelName);
+	channel->addUser(client, channelPassword);
 
 	//Announce to everybody on channel that a new client has arrived
-	std::string join_msg = ":" + client->getNickname() + "!" \
-	+ client->getUsername() + "@" + client->getHostname() + " JOIN #" \
-	+ channelName + "\r\n";
+	Reply join_line;
+	join_line.source(client->getPrefix()).word("JOIN").channel(channelName);
+	SharedMessage join_msg(join_line.data(), join_line.length());
 
-	std::vector<std::string> users = channel->getUserList();
-	for (size_t i = 0; i < users.size(); i++)
-	{
-		Client *user = getClientByNick(users[i]);
-		if (user)
-		{
-			if (send(user->getFd(), join_msg.c_str(), \
-				join_msg.length(), 0) == -1)
-				logMessage("ERROR: ", RED, \
-					"Failed to send JOIN message", YELLOW, ERR);
-		}
-	}
+	std::vector<ChannelMember> const &members = channel->getMembers();
+	for (size_t i = 0; i < members.size(); i++)
+		this->sendToClient(members[i].client, join_msg);
 
 	// Show topic if it exists
 	if (!channel->getTopic().empty())
-	{
-		std::string topic_msg = ":" + _server_name + " 332 " \
-		+ client->getNickname() + " #" + channelName + " :" \
-		+ channel->getTopic() + "\r\n";
-		send(client_fd, topic_msg.c_str(), topic_msg.length(), 0);
-	}
+		this->sendToClient(client, Reply().numeric(this->_server_name, \
+			RPL_TOPIC, client->getNickname()).channel(channelName) \
+			.trailing(channel->getTopic()));
 
-	//Send Names list to everybody on channel (updates list)
-	std::string names_list = channel->getUserListString();
-	for (size_t i = 0; i < users.size(); i++)
-	{
-		Client *user = getClientByNick(users[i]);
-		if (user)
-		{
-			std::string names_msg = ":" + _server_name + " 353 " \
-			+ user->getNickname() + " = #" + channelName + " :" \
-			+ names_list + "\r\n";
-			std::string end_names = ":" + _server_name + " 366 " \
-			+ user->getNickname() + " #" + channelName \
-			+ " :End of /NAMES list\r\n";
-			send(user->getFd(), names_msg.c_str(), names_msg.length(), 0);
-			send(user->getFd(), end_names.c_str(), end_names.length(), 0);
-		}
-	}
+	// Only the joiner needs the list, the others just saw the JOIN
+	channel->sendNames(this, client);
 	logMessage("User joined channel ", GREEN, channelName \
 		+ ": " + client->getNickname(), BLUE);
 }
 
-void Server::partChannel(std::string const &data, int client_fd)
+void Server::partChannel(IrcMessage const &msg, int client_fd)
 {
-	std::vector<std::string> tokens = _splitMessage(data);
-
-	if (tokens.size() < 2)
-	{
-		this->_sendErrorReply(client_fd, ERR_NEEDMOREPARAMS, \
-			"PART :Not enough parameters");
-		return;
-	}
-
-	std::string channelName = tokens[1];
+	std::string channelName = msg.getParam(0);
 	if (channelName[0] == '#')
 		channelName = channelName.substr(1);
 	
 	Channel *channel = getChannelByName(channelName);
 	if (!channel)
 	{
-		this->_sendErrorReply(client_fd, ERR_NOSUCHCHANNEL, "#" \
-			+ channelName + " :No such channel");
+		this->_sendChannelError(client_fd, ERR_NOSUCHCHANNEL, channelName, \
+			"No such channel");
 		return;
 	}
+	channelName = channel->getName();
 
 	Client *client = getClient(client_fd);
 	if (!client)
 		return;
 	
-	if (!channel->hasUser(client->getNickname()))
+	if (!channel->hasUser(client))
 	{
-		this->_sendErrorReply(client_fd, ERR_NOTONCHANNEL, "#" \
-			+ channelName + " :You're not on that channel");
+		this->_sendChannelError(client_fd, ERR_NOTONCHANNEL, channelName, \
+			"You're not on that channel");
 		return;
 	}
 
 	// Get part reason if provided
-	std::string reason = "";
-	size_t colon_pos = data.find(':', 5);
-	if (colon_pos != std::string::npos)
-		reason = data.substr(colon_pos + 1);
+	std::string reason = msg.getParam(1);
 
 	// Announce part to channel
 	channel->announcePart(this, client, reason);
 
 	// Remove user from channel
-	channel->removeUser(client->getNickname());
-	client->leaveChannel("#" + channelName);
+	channel->removeUser(client);
 
 	// Remove channel if empty
 	if (channel->isEmpty())
-	{
-		delete channel;
-		_channels.erase(channelName);
-		logMessage("Empty channel removed: ", YELLOW, channelName, RED);
-	}
+		this->_destroyChannel(channel);
 	logMessage("User left channel ", YELLOW, channelName + ": " \
 		+ client->getNickname(), BLUE);
 }
 
-void Server::handleChannelMode(std::string const &data, int client_fd)
+void Server::handleChannelMode(IrcMessage const &msg, int client_fd)
 {
-	std::vector<std::string> tokens = _splitMessage(data);
-
-	std::string channelName = tokens[1];
+	std::string channelName = msg.getParam(0);
 	if (channelName[0] == '#')
 		channelName = channelName.substr(1);
 
 	Channel *channel = getChannelByName(channelName);
 	if (!channel)
 	{
-		this->_sendErrorReply(client_fd, ERR_NOSUCHCHANNEL, "#" \
-			+ channelName + " :No such channel");
+		this->_sendChannelError(client_fd, ERR_NOSUCHCHANNEL, channelName, \
+			"No such channel");
 		return;
 	}
+	channelName = channel->getName();
 
 	Client *client = getClient(client_fd);
 	if (!client)
 		return;
 
 	// Check if user is in channel
-	if (!channel->hasUser(client->getNickname()))
+	if (!channel->hasUser(client))
 	{
-		this->_sendErrorReply(client_fd, ERR_NOTONCHANNEL, "#" \
-			+ channelName + " :You're not on that channel");
+		this->_sendChannelError(client_fd, ERR_NOTONCHANNEL, channelName, \
+			"You're not on that channel");
 		return;
 	}
 
-	if (tokens.size() < 3) // Just viewing modes
+	if (msg.paramCount() < 2) // Just viewing modes
 	{
-		std::string mode_msg = ":" + _server_name + " 324 " \
-		+ client->getNickname() + " #" + channelName + " " \
-		+ channel->getModeString() + "\r\n";
-		send(client_fd, mode_msg.c_str(), mode_msg.length(), 0);
+		this->sendToClient(client, Reply().numeric(this->_server_name, \
+			RPL_CHANNELMODEIS, client->getNickname()).channel(channelName) \
+			.word(channel->getModeString()));
 		return;
 	}
 
 	// Check operator privileges for mode changes
-	if (!channel->isOp(client->getNickname()))
+	if (!channel->isOp(client))
 	{
-		this->_sendErrorReply(client_fd, ERR_CHANOPRIVSNEEDED, "#" \
-		+ channelName + " :You're not channel operator");
+		this->_sendChannelError(client_fd, ERR_CHANOPRIVSNEEDED, channelName, \
+		"You're not channel operator");
 		return;
 	}
 
-	std::string modestring = tokens[2];
-	size_t param_index = 3;
+	std::string modestring = msg.getParam(1);
+	size_t param_index = 2;
 	bool adding = true;
 	std::string changes;
 	std::vector<std::string> change_params;
@@ -276,13 +223,13 @@ void Server::handleChannelMode(std::string const &data, int client_fd)
 			
 			// Get parameter if needed
 			if ((c == 'k' || c == 'l' || c == 'o') && adding \
-				&& param_index < tokens.size())
+				&& param_index < msg.paramCount())
 			{
-				param = tokens[param_index++];
+				param = msg.getParam(param_index++);
 			}
-			else if (c == 'o' && !adding && param_index < tokens.size())
+			else if (c == 'o' && !adding && param_index < msg.paramCount())
 			{
-				param = tokens[param_index++];
+				param = msg.getParam(param_index++);
 			}
 
 			// Apply mode change
@@ -316,12 +263,12 @@ void Server::handleChannelMode(std::string const &data, int client_fd)
 					if (!param.empty())
 					{
 						Client *target = getClientByNick(param);
-						if (target && channel->hasUser(param))
+						if (target && channel->hasUser(target))
 						{
 							if (adding)
-								success = channel->addOp(param);
+								success = channel->addOp(target);
 							else
-								success = channel->removeOp(param);
+								success = channel->removeOp(target);
 						}
 					}
 					break;
@@ -341,58 +288,56 @@ void Server::handleChannelMode(std::string const &data, int client_fd)
 	// Broadcast mode changes
 	if (!changes.empty())
 	{
-		std::string mode_change = ":" + client->getNickname() \
-		+ "!" + client->getUsername() + "@" + client->getHostname() \
-		+ " MODE #" + channelName + " " + changes;
+		Reply mode_change;
+		mode_change.source(client->getPrefix()).word("MODE") \
+			.channel(channelName).word(changes);
 		
 		for (size_t i = 0; i < change_params.size(); i++)
-			mode_change += " " + change_params[i];
-		mode_change += "\r\n";
+			mode_change.word(change_params[i]);
 
-		std::vector<std::string> users = channel->getUserList();
-		for (size_t i = 0; i < users.size(); i++)
-		{
-			Client *user = getClientByNick(users[i]);
-			if (user)
-			{
-				if (send(user->getFd(), mode_change.c_str(), \
-					mode_change.length(), 0) == -1)
-					logMessage("ERROR: ", RED, \
-						"Failed to send MODE change", YELLOW, ERR);
-			}
-		}
+		SharedMessage shared_change(mode_change.data(), mode_change.length());
+		std::vector<ChannelMember> const &members = channel->getMembers();
+		for (size_t i = 0; i < members.size(); i++)
+			this->sendToClient(members[i].client, shared_change);
 
 		logMessage("Mode changed for channel ", BLUE, channelName + \
 			": " + changes, GREEN);
 	}
 }
 
-void Server::sendMessageToTarget(std::string const &data, \
-	int client_fd, int type)
+void Server::privmsgCommand(IrcMessage const &msg, int client_fd)
+{
+	this->sendMessageToTarget(msg, client_fd, "PRIVMSG");
+}
+
+void Server::noticeCommand(IrcMessage const &msg, int client_fd)
+{
+	this->sendMessageToTarget(msg, client_fd, "NOTICE");
+}
+
+void Server::sendMessageToTarget(IrcMessage const &msg, \
+	int client_fd, std::string const &command)
 {
-	std::string command = (type == PRIVMSG) ? "PRIVMSG" : "NOTICE";
 	Client *sender = getClient(client_fd);
 	if (!sender)
 		return;
 
-	std::vector<std::string> tokens = _splitMessage(data);
-	
-	if (tokens.size() < 2)
+	if (msg.paramCount() < 1 || msg.param(0).empty())
 	{
-		this->_sendErrorReply(client_fd, ERR_NORECIPIENT, \
-			"No recipient given (PRIVMSG)");
+		this->sendToClient(sender, Reply().numeric(this->_server_name, \
+			ERR_NORECIPIENT, sender->getNickname()) \
+			.trailing("No recipient given (").text(command).text(")"));
 		return;
 	}
 
-	size_t colon = data.find(':', 8);
-	if (colon == std::string::npos)
+	if (msg.paramCount() < 2)
 	{
 		this->_sendErrorReply(client_fd, ERR_NOTEXTTOSEND, "No text to send");
 		return;
 	}
 	
-	std::string target = tokens[1];
-	std::string message = data.substr(colon);
+	std::string target = msg.getParam(0);
+	std::string message = ":" + msg.getParam(1);
 	
 	if (target[0] == '#')
 	{
@@ -401,30 +346,27 @@ void Server::sendMessageToTarget(std::string const &data, \
 
 		if (!channel)
 		{
-			this->_sendErrorReply(client_fd, ERR_NOSUCHCHANNEL, target \
-				+ " :No such channel");
+			this->_sendChannelError(client_fd, ERR_NOSUCHCHANNEL, channel_name, \
+				"No such channel");
 			return;
 		}
 		// Verify is user is in channel (for +n mode)
 		if (channel->hasMode(MODE_NO_EXTERNAL_MSGS) \
-			&& !channel->hasUser(sender->getNickname()))
+			&& !channel->hasUser(sender))
 		{
-			this->_sendErrorReply(client_fd, ERR_CANNOTSENDTOCHAN, target \
-				+ " :Cannot send to channel");
+			this->_sendChannelError(client_fd, ERR_CANNOTSENDTOCHAN, channel_name, \
+				"Cannot send to channel");
 			return;
 		}
 		// Verify moderated mode
-		if (channel->hasMode(MODE_MODERATED) && !channel->isOp(sender->getNickname()))
+		if (channel->hasMode(MODE_MODERATED) && !channel->isOp(sender))
 		{
-			this->_sendErrorReply(client_fd, ERR_CANNOTSENDTOCHAN, target \
-				+ " :Cannot send to channel");
+			this->_sendChannelError(client_fd, ERR_CANNOTSENDTOCHAN, channel_name, \
+				"Cannot send to channel");
 			return;
 		}
 		// Send message to channel, excluding sender (to avoid double message for the sender)
-		std::string sender_prefix = sender->getNickname() + "!" \
-		+ sender->getUsername() + "@" + sender->getHostname();
-
-		channel->sendMessage(this, sender_prefix, message, command);
+		channel->sendMessage(this, sender, message, command);
 	}
 	else
 	{
@@ -432,15 +374,11 @@ void Server::sendMessageToTarget(std::string const &data, \
 		Client *receiver = getClientByNick(target);
 		if (!receiver)
 		{
-			this->_sendErrorReply(client_fd, ERR_NOSUCHNICK, target + " :No such nick/channel");
+			this->_sendErrorReply(client_fd, ERR_NOSUCHNICK, target, \
+				"No such nick/channel");
 			return;
 		}
-		std::string returnMsg = ":" + sender->getNickname() + "!" \
-		+ sender->getUsername() + "@" +sender->getHostname() + " " \
-		+ command + " " + target + " " + message + "\r\n";
-		if (send(receiver->getFd(), returnMsg.c_str(), \
-			returnMsg.length(), 0) == -1)
-			logMessage("ERROR: ", RED, \
-				"Failed to send private message!", YELLOW, ERR);
+		this->sendToClient(receiver, Reply().source(sender->getPrefix()) \
+			.word(command).word(target).word(message));
 	}
 }
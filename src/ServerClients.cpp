@@ -12,35 +12,143 @@
 
 #include "../include/Server.hpp"
 
+// accept4() hands the socket over non-blocking in the same syscall
+static int acceptClient(int listen_fd, sockaddr_in *client_addr)
+{
+	socklen_t client_len = sizeof(*client_addr);
+#ifdef SOCK_NONBLOCK
+	return accept4(listen_fd, (struct sockaddr *)client_addr, &client_len, \
+		SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+	int client_socket = accept(listen_fd, (struct sockaddr *)client_addr, \
+		&client_len);
+	if (client_socket >= 0 && (fcntl(client_socket, F_SETFL, O_NONBLOCK) == -1 \
+		|| fcntl(client_socket, F_SETFD, FD_CLOEXEC) == -1))
+	{
+		close(client_socket);
+		return -1;
+	}
+	return client_socket;
+#endif
+}
+
+// For a listening socket Linux reports the accept queue length in
+// tcpi_unacked and its limit in tcpi_sacked
+static bool acceptQueue(int listen_fd, unsigned long &depth, \
+	unsigned long &limit)
+{
+#if defined(__linux__) && defined(TCP_INFO)
+	struct tcp_info info;
+	socklen_t length = sizeof(info);
+
+	if (getsockopt(listen_fd, IPPROTO_TCP, TCP_INFO, &info, &length) == -1)
+		return false;
+	depth = info.tcpi_unacked;
+	limit = info.tcpi_sacked;
+	return true;
+#else
+	(void)listen_fd;
+	(void)depth;
+	(void)limit;
+	return false;
+#endif
+}
+
+// Drains the accept queue in one go, bounded so a reconnect storm cannot
+// starve this loop's clients: what is left is reported ready again
 void Server::_acceptNewClient(void)
 {
-	struct sockaddr_in client_addr;
-	socklen_t client_len = sizeof(client_addr);
-	int client_socket = accept(this->_server_fd, (struct sockaddr *)&client_addr, &client_len);
-					
-	if (client_socket < 0)
+	Shard *shard = this->_currentShard();
+	unsigned long accepted = 0;
+
+	// Sampled before draining, when the queue is at its deepest
+	unsigned long depth;
+	unsigned long limit;
+	if (acceptQueue(shard->listen_fd, depth, limit))
+		shard->stats.countAcceptQueue(depth, limit);
+
+	while (accepted < ACCEPT_BATCH_MAX)
 	{
-		logMessage("ERROR: ", RED, "Accept failed!", YELLOW, ERR);
+		struct sockaddr_in client_addr;
+		int client_socket = acceptClient(shard->listen_fd, &client_addr);
+
+		if (client_socket < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue; // That one connection is gone, the queue is not
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				this->_pauseAccept(shard, errno);
+			break;
+		}
+		accepted++;
+		this->_addClient(shard, client_socket, client_addr);
+	}
+	if (accepted > 0)
+		shard->stats.countAccepts(accepted, time(NULL));
+}
+
+// Out of descriptors or memory the queue stays readable and a level
+// triggered listener would wake us in a loop: stop watching it for a while,
+// the pending connections wait in the kernel queue
+void Server::_pauseAccept(Shard *shard, int error)
+{
+	unsigned long now = monotonicMs();
+
+	shard->stats.accept_failures++;
+	shard->reactor->remove(shard->listen_fd);
+	shard->accept_resume_ms = now + ACCEPT_PAUSE_MS;
+
+	shard->accept_unlogged++;
+	if (shard->accept_logged_ms != 0 \
+		&& now - shard->accept_logged_ms < ACCEPT_LOG_INTERVAL_MS)
 		return;
+	logMessage("ERROR: ", RED, "Accept failed (" + std::string(strerror(error)) \
+		+ "), " + itoa(static_cast<int>(shard->accept_unlogged)) \
+		+ " time(s) since last report, pausing accepts", YELLOW, ERR);
+	shard->accept_logged_ms = now;
+	shard->accept_unlogged = 0;
+}
+
+// Watches a paused listener again once its pause is over, and otherwise
+// shortens the wait timeout so the loop wakes up for it
+int Server::_resumeAccept(Shard *shard, int timeout)
+{
+	if (shard->accept_resume_ms == 0)
+		return timeout;
+
+	unsigned long now = monotonicMs();
+	if (now < shard->accept_resume_ms)
+	{
+		int left = static_cast<int>(shard->accept_resume_ms - now);
+		return (timeout < 0 || timeout > left) ? left : timeout;
 	}
-	
-	if (fcntl(client_socket, F_SETFL, O_NONBLOCK) == -1)
+	shard->accept_resume_ms = 0;
+	if (!shard->reactor->add(shard->listen_fd, IO_READ))
+		this->_pauseAccept(shard, errno);
+	return timeout;
+}
+
+void Server::_addClient(Shard *shard, int client_socket, \
+	sockaddr_in const &client_addr)
+{
+	// Output is already batched per tick, Nagle would only delay it
+	int nodelay = 1;
+	setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+	//Readiness setup for client socket
+	if (!shard->reactor->add(client_socket, IO_READ))
 	{
-		logMessage("ERROR: ", RED, "Failed to set client socket non-blocking!", YELLOW, ERR);
+		logMessage("ERROR: ", RED, "Failed to watch client socket!", YELLOW, ERR);
 		close(client_socket);
 		return;
 	}
-	
+
 	//Create new client and add it to the map according to its fd 
 	Client* new_client = new Client(client_socket, client_addr);
-	this->_clients[client_socket] = new_client;
-	
-	//Poll setup for client socket
-	struct pollfd client_pollfd;
-	client_pollfd.fd = client_socket;
-	client_pollfd.events = POLLIN;
-	client_pollfd.revents = 0;
-	this->_poll_fds.push_back(client_pollfd);
+	new_client->setShard(shard);
+	new_client->setWatchedEvents(IO_READ);
+	shard->clients.insert(client_socket, new_client);
+	this->_armClientTimer(new_client, this->_config.registration_timeout);
 }
 
 
@@ -52,46 +160,58 @@ void Server::_handleClientData(int client_fd)
 	if (!client)
 		return;
 	
-	memset(buffer, 0, BUFFER_SIZE);
-	int bytes_received = recv(client_fd, buffer, BUFFER_SIZE - 1, 0);
+	// Only read what the input buffer can take, the rest stays in the
+	// socket and is reported ready again on the next wait
+	size_t space = client->getBufferSpace();
+	if (space == 0 || space > BUFFER_SIZE)
+		space = BUFFER_SIZE; // A line longer than the buffer gets dropped
+	int bytes_received = recv(client_fd, buffer, space, 0);
+	client->getShard()->stats.read_calls++;
 	
 	if (bytes_received <= 0)
 	{
 		if (bytes_received == 0)
+		{
+			ScopedLock world(this->_world_lock);
 			this->_removeClient(client_fd);
+		}
 		return;        
 	}
-	   
-	buffer[bytes_received] = '\0';
+
+	// Closing: input is only read so it can't turn the close into a reset
+	if (client->isClosing())
+		return;
 	
-	// // Clean problematic control characters from buffer
-	std::string data;
+	// Clean problematic control characters in place, but keep \r\n
+	int length = 0;
 	for (int i = 0; i < bytes_received; i++)
 	{
 		unsigned char c = static_cast<unsigned char>(buffer[i]);
 		
-		// Filter control characters, but keep \r\n
 		if (c >= 32 || c == '\r' || c == '\n' || c == '\t')
 		{
-			data += c;
+			buffer[length++] = c;
 		}
 		else if (c == 4) // Ctrl+D (EOF)
 		{
 			// Ignores Ctrl+D but continues processing
-			logMessage("Ctrl+D received from FD ", YELLOW, \
+			LOG_DEBUG("Ctrl+D received from FD ", YELLOW, \
 				 itoa(client_fd), WHITE);
 			continue;
 		}
 	}
 	
-	if (data.empty())
+	if (length == 0)
 		return;
 	
-	if(data.find("PONG", 0, 4) == std::string::npos)
-		logMessage("from FD = " + itoa(client_fd) + ":\n", BLUE, data, WHITE);
+	LOG_DEBUG("from FD = " + itoa(client_fd) + ":\n", BLUE, \
+		std::string(buffer, length), WHITE);
 	
 	// Always add data to buffer first
-	client->appendBuffer(data);
+	client->appendBuffer(buffer, length);
+	
+	// Commands read and change state shared with the other shards
+	ScopedLock world(this->_world_lock);
 	
 	// If the client is not registered, do it so
 	if(!client->isRegistered())
@@ -99,15 +219,14 @@ void Server::_handleClientData(int client_fd)
 		bool processed_any_command = false;
 		
 		// Processes all the register commands available on buffer
-		while(client->isDataComplete())
+		LineView line;
+		while(client->getNextCompleteMessage(line))
 		{
-			std::string message = client->getNextCompleteMessage();
-			
-			if (message.empty())
-				break;
+			std::string message(line.data, line.length);
 			
-			logMessage("Processing registration command: ", CYAN, message, WHITE);
+			LOG_DEBUG("Processing registration command: ", CYAN, message, WHITE);
 			processed_any_command = true;
+			client->getShard()->stats.commands++;
 			
 			// Processes register commands
 			if (message.length() >= 5)
@@ -167,16 +286,15 @@ void Server::_handleClientData(int client_fd)
 					RED, client->getNickname(), YELLOW);
 				this->_sendErrorReply(client_fd, ERR_PASSWDMISMATCH, \
 					"Password incorrect!");
-				// Waits before disconnecting to avoid "connection reset"
-				usleep(100000); // 100ms
-				this->_removeClient(client_fd);
+				this->_closeClient(client);
 				return;
 			}
 			
 			// Checks nickname duplicates
 			std::string nick = this->_checkDoubles(client->getNickname(), client_fd);
-			client->setNickname(nick);
+			this->_setNickname(client, nick);
 			this->_welcomeMessage(client);
+			this->_armClientTimer(client, this->_config.ping_interval);
 			logMessage("Client fully registered: ", GREEN, \
 				client->getNickname(), BLUE);
 		}
@@ -185,17 +303,15 @@ void Server::_handleClientData(int client_fd)
 
 		
 	// Client is registered, process commands normally
-	while(client->isDataComplete())
+	// Each line is tokenized once, in place, and handed to the handlers
+	LineView line;
+	while(client->getNextCompleteMessage(line))
 	{
-		std::string message = client->getNextCompleteMessage();
-		
-		if (message.empty())
-			break;
-			
-		int command_code = this->parseCommand(message);
+		IrcMessage message(line.data, line.length);
+		client->getShard()->stats.commands++;
 		
 		// Execute command and check if the client was removed
-		bool client_still_exists = this->executeCommand(client_fd, command_code, message);
+		bool client_still_exists = this->executeCommand(client_fd, message);
 		
 		if (!client_still_exists)
 		{
@@ -211,57 +327,51 @@ void Server::_handleClientData(int client_fd)
 
 void Server::_removeClient(int client_fd)
 {
-	// Remove from poll_fds first
-	std::vector<struct pollfd>::iterator poll_it;
-	for (poll_it = this->_poll_fds.begin(); \
-		poll_it != this->_poll_fds.end(); poll_it++)
-	{
-		if(poll_it->fd == client_fd)
-		{
-			this->_poll_fds.erase(poll_it);
-			break;
-		}
-	}
+	Shard *shard = this->_currentShard();
+
+	// Stop watching the socket first
+	shard->reactor->remove(client_fd);
 	
 	// Find and remove client
-	std::map<int, Client*>::iterator client_it = this->_clients.find(client_fd);
-	if (client_it != this->_clients.end())
+	Client **client_slot = shard->clients.find(client_fd);
+	if (client_slot)
 	{
-		Client *client = client_it->second;
+		Client *client = *client_slot;
 		
 		// Remove client from all channels before deleting
 		if (client)
 		{
-			std::set<std::string> client_channels = client->getChannels();
-			std::string client_nick = client->getNickname();
-			
-			for (std::set<std::string>::const_iterator it = client_channels.begin(); it != client_channels.end(); ++it)
+			// removeUser() unlinks the channel, so keep taking the last one
+			while (!client->getChannels().empty())
 			{
-				std::string channel_name = *it;
-				if (channel_name[0] == '#')
-					channel_name = channel_name.substr(1);
-					
-				Channel *channel = getChannelByName(channel_name);
-				if (channel)
-				{
-					channel->removeUser(client_nick);
-					
-					// Remove empty channels
-					if (channel->isEmpty())
-					{
-						delete channel;
-						_channels.erase(channel_name);
-						logMessage("Empty channel removed: ", YELLOW, channel_name, RED);
-					}
-				}
+				Channel *channel = client->getChannels().back().channel;
+				channel->removeUser(client);
+				
+				// Remove empty channels
+				if (channel->isEmpty())
+					this->_destroyChannel(channel);
 			}
 		}
 		
-		// Now safe to delete client
+		// Release the nick, queued output goes away with the client
+		if (client)
+		{
+			Client **owner = this->_nicks.find(client->getNickname());
+			if (owner && *owner == client)
+				this->_nicks.erase(client->getNickname());
+		}
+
+		// Now safe to delete client, ~Client() closes the socket. Closing
+		// it again here could hit a connection another shard just accepted
+		// on the reused descriptor.
+		if (client)
+			shard->timers.cancel(&client->getTimer());
 		delete client;
-		this->_clients.erase(client_it);
+		shard->clients.erase(client_fd);
+		if (!client)
+			close(client_fd);
 	}
-
-	close(client_fd);
+	else
+		close(client_fd);
 	logMessage("Client disconnected! FD = ", RED, itoa(client_fd), YELLOW);
 }
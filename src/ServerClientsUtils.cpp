@@ -12,156 +12,129 @@
 
 #include "../include/Server.hpp"
 
+// Descriptors are per shard: only clients of the calling shard are found
 Client *Server::getClient(int client_fd)
 {
-	std::map<int, Client*>::iterator it = this->_clients.find(client_fd); 
-	
-	// Robust validation: clients* exists in std::map and is not NULL
-	if (it != this->_clients.end() && it->second != NULL)
-		return it->second;
+	Shard *shard = this->_currentShard();
+	if (!shard)
+		return NULL;
+
+	Client **slot = shard->clients.find(client_fd);
+
+	// Robust validation: fd has a slot in the table and it is not NULL
+	if (slot && *slot != NULL)
+		return *slot;
 	else
 		return NULL;
 }
 
 Client *Server::getClientByNick(std::string const &nick)
 {
-	std::string formattedNick = nick;
-	
+	Client **client;
+
 	// Remove spaces and other chars
-	size_t pos = formattedNick.find_first_of(" \r\n");
+	size_t pos = nick.find_first_of(" \r\n");
 	if (pos != std::string::npos)
-		formattedNick.erase(pos);
+		client = this->_nicks.find(nick.substr(0, pos));
+	else
+		client = this->_nicks.find(nick);
+	return (client ? *client : NULL);
+}
 
-	std::map<int, Client*>::iterator client_it;
-	for (client_it = this->_clients.begin(); \
-		client_it != this->_clients.end(); client_it++)
-	{
-		Client *temp = client_it->second;
-		if(temp->getNickname() == formattedNick)
-			return temp;
-	}
-	return NULL;
+// Every nickname change of a registered client goes through here so the
+// nick index always matches Client::getNickname()
+void Server::_setNickname(Client *client, std::string const &nickname)
+{
+	Client **owner = this->_nicks.find(client->getNickname());
+	if (owner && *owner == client)
+		this->_nicks.erase(client->getNickname());
+
+	client->setNickname(nickname);
+	if (!client->getNickname().empty())
+		this->_nicks.insert(client->getNickname(), client);
 }
 
-void Server::changeNick(std::string const &data, int client_fd)
+void Server::changeNick(IrcMessage const &msg, int client_fd)
 {
-	std::vector<std::string> tokens = _splitMessage(data);
-	
-	if (tokens.size() < 2)
+	if (msg.paramCount() < 1 || msg.param(0).empty())
 	{
 		this->_sendErrorReply(client_fd, ERR_NONICKNAMEGIVEN, \
 			"No nickname given");
 		return;
 	}
 	
-	Client *client = this->_clients[client_fd];
+	Client *client = this->getClient(client_fd);
 	if (!client)
 		return;
 	
+	std::string requested = msg.getParam(0);
 	std::string old_nick = client->getNickname();
-	std::string new_nickname = this->_checkDoubles(tokens[1], client_fd);
+	std::string new_nickname = this->_checkDoubles(requested, client_fd);
 	
 	// If nick didn't change (including cases in which "_" was added) still process it
-	if (old_nick == new_nickname && tokens[1] == new_nickname)
+	if (old_nick == new_nickname && requested == new_nickname)
 		return; // Same nick, no change needed
-	// Prepares NICK message
-	std::string nick_msg = ":" + old_nick + "!" + client->getUsername() \
-	+ "@" + client->getHostname() + " NICK :" + new_nickname + "\r\n";
+	// Prepares NICK message, the prefix still holds the old nick
+	Reply nick_line;
+	nick_line.source(client->getPrefix()).word("NICK").trailing(new_nickname);
+	SharedMessage nick_msg(nick_line.data(), nick_line.length());
 	
 	// Collects all clients that need to be notified
-	std::set<int> clients_to_notify;
-	std::set<std::string> client_channels = client->getChannels();
+	std::set<Client*> clients_to_notify;
+	std::vector<ChannelLink> const &client_channels = client->getChannels();
 	
-	// For any channel the user is in
-	for (std::set<std::string>::const_iterator it = client_channels.begin(); \
-		it != client_channels.end(); ++it)
+	// For any channel the user is in (membership is by handle, so only
+	// the cached NAMES entry has to change with the nick)
+	for (size_t i = 0; i < client_channels.size(); i++)
 	{
-		std::string channel_name = *it;
-		if (channel_name[0] == '#')
-			channel_name = channel_name.substr(1);
-		
-		Channel *channel = getChannelByName(channel_name);
-		if (channel)
+		std::vector<ChannelMember> const &members = \
+			client_channels[i].channel->getMembers();
+		for (size_t j = 0; j < members.size(); j++)
 		{
-			// Updates nick using this method
-			channel->updateUserNick(old_nick, new_nickname);
-			
-			// Collects users from channel to announce the nick change
-			std::vector<std::string> users = channel->getUserList();
-			for (size_t i = 0; i < users.size(); i++)
-			{
-				Client *user = getClientByNick(users[i]);
-				if (user && user->getFd() != client_fd)
-				{
-					clients_to_notify.insert(user->getFd());
-				}
-			}
+			if (members[j].client != client)
+				clients_to_notify.insert(members[j].client);
 		}
 	}
 	
-	// Updates client nickname
-	client->setNickname(new_nickname);
+	// Updates client nickname, then its entry in each cached NAMES list
+	this->_setNickname(client, new_nickname);
+	for (size_t i = 0; i < client_channels.size(); i++)
+		client_channels[i].channel->renameUser(client, old_nick);
 	
 	// Sends confirmation to the client itself
-	if (send(client_fd, nick_msg.c_str(), nick_msg.length(), 0) == -1)
-		logMessage("ERROR: ", RED, "Failed to send NICK response!", \
-			YELLOW, ERR);
+	this->sendToClient(client, nick_msg);
 	
 	// Notify all collected clients
-	for (std::set<int>::iterator it = clients_to_notify.begin(); \
+	for (std::set<Client*>::iterator it = clients_to_notify.begin(); \
 		it != clients_to_notify.end(); ++it)
-	{
-		if (send(*it, nick_msg.c_str(), nick_msg.length(), 0) == -1)
-			logMessage("ERROR: ", RED, \
-				"Failed to broadcast NICK change", YELLOW, ERR);
-	}
+		this->sendToClient(*it, nick_msg);
 	
 	logMessage("Nickname changed: ", GREEN, old_nick + " -> " \
 		+ new_nickname, BLUE);
 }
 
-void Server::quitServer(std::string const &data, int client_fd, std::string msg)
+void Server::quitServer(int client_fd, std::string const &reason)
 {
 	Client *client = getClient(client_fd);
 	if (!client)
 		return;
 	
-	size_t colon_pos = data.find(':');
-	if (colon_pos != std::string::npos)
-		msg = data.substr(colon_pos + 1);
-	
-	// Gets channel list before removing client
-	std::set<std::string> client_channels = client->getChannels();
 	std::string client_nick = client->getNickname();
-	std::string client_user = client->getUsername();
-	std::string client_host = client->getHostname();
 	
-	// Notify channels about the quitting
-	for (std::set<std::string>::const_iterator it = client_channels.begin(); \
-		it != client_channels.end(); ++it)
+	// Notify channels about the quitting, removeUser() unlinks each one
+	while (!client->getChannels().empty())
 	{
-		std::string channel_name = *it;
-		if (channel_name[0] == '#')
-			channel_name = channel_name.substr(1);
-			
-		Channel *channel = getChannelByName(channel_name);
-		if (channel)
-		{
-			// Removes user from channel
-			channel->removeUser(client_nick);
-			
-			// Announces quit for the other users
-			channel->announceQuit(this, client, msg);
-			
-			// Removes channel if it is empty
-			if (channel->isEmpty())
-			{
-				delete channel;
-				_channels.erase(channel_name);
-				logMessage("Empty channel removed: ", \
-					YELLOW, channel_name, RED);
-			}
-		}
+		Channel *channel = client->getChannels().back().channel;
+
+		// Removes user from channel
+		channel->removeUser(client);
+		
+		// Announces quit for the other users
+		channel->announceQuit(this, client, reason);
+		
+		// Removes channel if it is empty
+		if (channel->isEmpty())
+			this->_destroyChannel(channel);
 	}
 	
 	logMessage("Client quit! Nick: ", YELLOW, client_nick, GREEN);
@@ -169,3 +142,22 @@ void Server::quitServer(std::string const &data, int client_fd, std::string msg)
 	// Removes client
 	this->_removeClient(client_fd);
 }
+
+void Server::quitCommand(IrcMessage const &msg, int client_fd)
+{
+	this->quitServer(client_fd, msg.getParam(0, "Client quit"));
+}
+
+// Answer to the keepalive PING: the client gets a fresh idle period
+void Server::pongCommand(IrcMessage const &msg, int client_fd)
+{
+	(void)msg;
+	Client *client = this->getClient(client_fd);
+	if (!client || !client->getPingSent())
+		return;
+
+	LOG_DEBUG("PONG lag (ms) from " + client->getNickname() + ": ", CYAN, \
+		itoa(monotonicMs() - client->getPingSent()), WHITE);
+	client->setPingSent(0);
+	this->_armClientTimer(client, this->_config.ping_interval);
+}
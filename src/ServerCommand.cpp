@@ -11,58 +11,40 @@
 /* ************************************************************************** */
 
 #include "../include/Server.hpp"
+#include <fstream>
 
-int Server::parseCommand(const std::string& data)
+// Handshakes the host dropped on full accept queues (all listeners of the
+// network namespace), -1 where /proc/net/netstat is not available
+static long listenOverflows(void)
 {
-	std::vector<std::string> tokens = _splitMessage(data);
-	if (tokens.empty())
-		return NO_COMM;
-	
-	std::string command = tokens[0];
-	
-	if(command == "JOIN")
-		return JOIN;
-	if(command == "PRIVMSG")
-		return PRIVMSG;
-	if(command == "NOTICE")
-		return NOTICE;
-	if(command == "NICK")
-		return NICK;
-	if(command == "QUIT")
-		return QUIT;
-	if(command == "PART")
-		return PART;
-	if(command == "KICK")
-		return KICK;
-	if(command == "INVITE")
-		return INVITE;
-	if(command == "TOPIC")
-		return TOPIC;
-	if(command == "MODE")
-		return MODE;
-	if(command == "PONG")
-		return PONG;
+	std::ifstream netstat("/proc/net/netstat");
+	std::string names;
+	std::string values;
 
-	return NO_COMM;
+	// Lines come in pairs: field names, then their values
+	while (std::getline(netstat, names) && std::getline(netstat, values))
+	{
+		if (names.compare(0, 7, "TcpExt:") != 0)
+			continue;
+		std::istringstream name_stream(names);
+		std::istringstream value_stream(values);
+		std::string name;
+		std::string value;
+		while (name_stream >> name && value_stream >> value)
+		{
+			if (name == "ListenOverflows")
+				return atol(value.c_str());
+		}
+	}
+	return -1;
 }
 
-void Server::modeCommand(std::string const &data, int client_fd)
+void Server::modeCommand(IrcMessage const &msg, int client_fd)
 {
-	std::vector<std::string> tokens = _splitMessage(data);
-	
-	if (tokens.size() < 2)
-	{
-		this->_sendErrorReply(client_fd, ERR_NEEDMOREPARAMS, \
-			"MODE :Not enough parameters");
-		return;
-	}
-	
-	std::string target = tokens[1];
-	
 	// Channel mode
-	if (target[0] == '#')
+	if (msg.param(0).data[0] == '#')
 	{
-		handleChannelMode(data, client_fd);
+		handleChannelMode(msg, client_fd);
 	}
 	else
 	{
@@ -71,122 +53,156 @@ void Server::modeCommand(std::string const &data, int client_fd)
 	}
 }
 
-void Server::topicCommand(std::string const &data, int client_fd)
+void Server::topicCommand(IrcMessage const &msg, int client_fd)
 {
-	std::vector<std::string> tokens = _splitMessage(data);
-	
-	if (tokens.size() < 2)
-	{
-		this->_sendErrorReply(client_fd, ERR_NEEDMOREPARAMS, \
-			"TOPIC :Not enough parameters");
-		return;
-	}
-	
-	std::string channelName = tokens[1];
+	std::string channelName = msg.getParam(0);
 	if (channelName[0] == '#')
 		channelName = channelName.substr(1);
 	
 	Channel *channel = getChannelByName(channelName);
 	if (!channel)
 	{
-		this->_sendErrorReply(client_fd, ERR_NOSUCHCHANNEL, "#" \
-			+ channelName + " :No such channel");
+		this->_sendChannelError(client_fd, ERR_NOSUCHCHANNEL, channelName, \
+			"No such channel");
 		return;
 	}
+	channelName = channel->getName();
 	
 	Client *client = getClient(client_fd);
 	if (!client)
 		return;
 	
 	// Check if user is in channel
-	if (!channel->hasUser(client->getNickname()))
+	if (!channel->hasUser(client))
 	{
-		this->_sendErrorReply(client_fd, ERR_NOTONCHANNEL, "#" \
-			+ channelName + " :You're not on that channel");
+		this->_sendChannelError(client_fd, ERR_NOTONCHANNEL, channelName, \
+			"You're not on that channel");
 		return;
 	}
 	
-	size_t colon_pos = data.find(':', 6);
-	
-	if (colon_pos == std::string::npos) // No new topic, just viewing
+	if (msg.paramCount() < 2) // No new topic, just viewing
 	{
-		std::string topic = channel->getTopic();
+		std::string const &topic = channel->getTopic();
 		if (topic.empty())
-		{
-			std::string no_topic = ":" + _server_name + " 331 " \
-			+ client->getNickname() + " #" + channelName \
-			+ " :No topic is set\r\n";
-			send(client_fd, no_topic.c_str(), no_topic.length(), 0);
-		}
+			this->sendToClient(client, Reply().numeric(this->_server_name, \
+				RPL_NOTOPIC, client->getNickname()).channel(channelName) \
+				.trailing("No topic is set"));
 		else
-		{
-			std::string topic_msg = ":" + _server_name + " 332 " \
-			+ client->getNickname() + " #" + channelName + " :" \
-			+ topic + "\r\n";
-			send(client_fd, topic_msg.c_str(), topic_msg.length(), 0);
-		}
+			this->sendToClient(client, Reply().numeric(this->_server_name, \
+				RPL_TOPIC, client->getNickname()).channel(channelName) \
+				.trailing(topic));
 		return;
 	}
 	
 	// Setting new topic
-	if (!channel->canUserSetTopic(client->getNickname()))
+	if (!channel->canUserSetTopic(client))
 	{
-		this->_sendErrorReply(client_fd, ERR_CHANOPRIVSNEEDED, "#" \
-			+ channelName + " :You're not channel operator");
+		this->_sendChannelError(client_fd, ERR_CHANOPRIVSNEEDED, channelName, \
+			"You're not channel operator");
 		return;
 	}
 	
-	std::string newTopic = data.substr(colon_pos + 1);
+	std::string newTopic = msg.getParam(1);
 	channel->setTopic(newTopic);
 	
 	// Broadcast topic change to channel
-	std::string topic_change = ":" + client->getNickname() + "!" \
-	+ client->getUsername() + "@" + client->getHostname() + " TOPIC #" \
-	+ channelName + " :" + newTopic + "\r\n";
+	Reply topic_line;
+	topic_line.source(client->getPrefix()).word("TOPIC").channel(channelName) \
+		.trailing(newTopic);
+	SharedMessage topic_change(topic_line.data(), topic_line.length());
 	
-	std::vector<std::string> users = channel->getUserList();
-	for (size_t i = 0; i < users.size(); i++)
-	{
-		Client *user = getClientByNick(users[i]);
-		if (user)
-		{
-			if (send(user->getFd(), topic_change.c_str(), \
-				topic_change.length(), 0) == -1)
-				logMessage("ERROR: ", RED, \
-					"Failed to send TOPIC change", YELLOW, ERR);
-		}
-	}
+	std::vector<ChannelMember> const &members = channel->getMembers();
+	for (size_t i = 0; i < members.size(); i++)
+		this->sendToClient(members[i].client, topic_change);
 	
 	logMessage("Topic changed for channel ", BLUE, channelName + ": " \
 		+ newTopic, GREEN);
 }
 
-bool Server::executeCommand(int client_fd, int command_code, std::string const &data)
+void Server::statsCommand(IrcMessage const &msg, int client_fd)
 {
-	Client *client = this->getClient(client_fd);
+	Client *client = getClient(client_fd);
+	if (!client)
+		return;
 
-	if (command_code != QUIT && client) // QUIT does not need activity feedback
-		client->setLastActivity(time(NULL));
+	std::string query = msg.param(0).empty() ? "*" : msg.getParam(0).substr(0, 1);
+	std::string prefix = ":" + _server_name + " ";
 
-	switch (command_code)
+	// p: pool occupancy, objects in use / preallocated
+	if (query == "p")
 	{
-		case JOIN:	this->joinChannel(data, client_fd); break;
-		case PRIVMSG:this->sendMessageToTarget(data, client_fd); break;
-		case NOTICE:this->sendMessageToTarget(data, client_fd, NOTICE); break;
-		case NICK:	this->changeNick(data, client_fd); break;
-		case PART:	this->partChannel(data, client_fd); break;
-		case KICK:	this->kickUser(data, client_fd); break;
-		case INVITE:this->inviteUser(data, client_fd); break;
-		case TOPIC:	this->topicCommand(data, client_fd); break;
-		case MODE:	this->modeCommand(data, client_fd); break;
-		case PONG:	break;
+		std::ostringstream oss;
+		oss << prefix << RPL_STATSDEBUG << " " << client->getNickname() \
+			<< " p :clients " << Client::pool().inUse() \
+			<< "/" << Client::pool().capacity() \
+			<< " channels " << Channel::pool().inUse() \
+			<< "/" << Channel::pool().capacity() << "\r\n";
+		this->sendToClient(client, oss.str());
+	}
 
-		case QUIT:
-			this->quitServer(data, client_fd);
-			return false; // Client removed
+	// m: invocation count and latency histogram per command
+	if (query == "m")
+		this->_reportCommandStats(client);
 
-		default:
-			break;
+	// z: I/O counters, syscalls per processed command
+	if (query == "z")
+	{
+		// Other shards keep counting meanwhile, read them atomically
+		ShardStats total;
+		time_t now = time(NULL);
+		unsigned long accept_rate = 0;
+		for (size_t i = 0; i < this->_shards.size(); i++)
+		{
+			ShardStats stats = this->_shards[i]->stats.snapshot();
+			total.commands += stats.commands;
+			total.read_calls += stats.read_calls;
+			total.write_calls += stats.write_calls;
+			total.bytes_out += stats.bytes_out;
+			total.replies_truncated += stats.replies_truncated;
+			total.accepted += stats.accepted;
+			// Best seconds of different shards need not be the same second
+			if (stats.accept_peak > total.accept_peak)
+				total.accept_peak = stats.accept_peak;
+			total.accept_queue_full += stats.accept_queue_full;
+			total.accept_failures += stats.accept_failures;
+			if (stats.accept_queue_peak > total.accept_queue_peak)
+				total.accept_queue_peak = stats.accept_queue_peak;
+			if (stats.accept_queue_limit > total.accept_queue_limit)
+				total.accept_queue_limit = stats.accept_queue_limit;
+			accept_rate += stats.acceptRate(now);
+		}
+		unsigned long commands = total.commands ? total.commands : 1;
+		std::ostringstream oss;
+		oss << prefix << RPL_STATSDEBUG << " " << client->getNickname() \
+			<< " z :commands " << total.commands \
+			<< " reads " << total.read_calls \
+			<< " writes " << total.write_calls \
+			<< " bytes_out " << total.bytes_out \
+			<< " shards " << this->_shards.size() << "\r\n";
+		oss << prefix << RPL_STATSDEBUG << " " << client->getNickname() \
+			<< " z :reads/command " << std::fixed << std::setprecision(2) \
+			<< static_cast<double>(total.read_calls) / commands \
+			<< " writes/command " \
+			<< static_cast<double>(total.write_calls) / commands \
+			<< " queued_bytes " << SharedMessage::getLiveBytes() \
+			<< " replies_truncated " << total.replies_truncated \
+			<< " log_dropped " << logDropped() << "\r\n";
+		oss << prefix << RPL_STATSDEBUG << " " << client->getNickname() \
+			<< " z :accepted " << total.accepted \
+			<< " accepts/sec " << accept_rate \
+			<< " peak_shard_accepts/sec " << total.accept_peak \
+			<< " accept_queue_peak " << total.accept_queue_peak << "/" \
+			<< (total.accept_queue_limit ? total.accept_queue_limit \
+				: this->_config.listen_backlog) \
+			<< " accept_queue_full " << total.accept_queue_full \
+			<< " accept_failures " << total.accept_failures;
+		long overflows = listenOverflows();
+		if (overflows >= 0)
+			oss << " listen_overflows " << overflows;
+		oss << "\r\n";
+		this->sendToClient(client, oss.str());
 	}
-	return true;
+	this->sendToClient(client, Reply().numeric(this->_server_name, \
+		RPL_ENDOFSTATS, client->getNickname()).word(query) \
+		.trailing("End of /STATS report"));
 }
@@ -0,0 +1,187 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ServerDispatch.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 16:31:26 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 16:31:26 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Server.hpp"
+
+#include <time.h>
+#include <strings.h>
+
+// Every command a registered client can send
+static const CommandSpec g_commands[] =
+{
+	// name		handler						min_params	needs_registration
+	{ "JOIN",		&Server::joinChannel,		1,	true },
+	{ "PRIVMSG",	&Server::privmsgCommand,	0,	true },
+	{ "NOTICE",		&Server::noticeCommand,		0,	true },
+	{ "NICK",		&Server::changeNick,		0,	true },
+	{ "QUIT",		&Server::quitCommand,		0,	false },
+	{ "PART",		&Server::partChannel,		1,	true },
+	{ "KICK",		&Server::kickUser,			2,	true },
+	{ "INVITE",		&Server::inviteUser,		2,	true },
+	{ "TOPIC",		&Server::topicCommand,		1,	true },
+	{ "MODE",		&Server::modeCommand,		1,	true },
+	{ "PONG",		&Server::pongCommand,		0,	false },
+	{ "STATS",		&Server::statsCommand,		0,	true },
+};
+
+#define COMMAND_COUNT	(sizeof(g_commands) / sizeof(g_commands[0]))
+#define COMMAND_SLOTS	32	// Power of two, larger than COMMAND_COUNT
+
+static unsigned char upper(unsigned char c)
+{
+	return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+}
+
+// Collision free for the verbs above: first and last letter plus length
+static size_t commandHash(const char *verb, size_t length)
+{
+	return (upper(verb[0]) + 7 * upper(verb[length - 1]) + length) \
+		& (COMMAND_SLOTS - 1);
+}
+
+// Slot -> command table index (-1 when free), filled before main()
+struct CommandIndex
+{
+	int slots[COMMAND_SLOTS];
+
+	CommandIndex()
+	{
+		for (size_t i = 0; i < COMMAND_SLOTS; i++)
+			this->slots[i] = -1;
+
+		// Linear probing keeps lookups correct if a new verb ever collides
+		for (size_t i = 0; i < COMMAND_COUNT; i++)
+		{
+			size_t slot = commandHash(g_commands[i].name, \
+				strlen(g_commands[i].name));
+			while (this->slots[slot] != -1)
+				slot = (slot + 1) & (COMMAND_SLOTS - 1);
+			this->slots[slot] = static_cast<int>(i);
+		}
+	}
+};
+
+static const CommandIndex g_command_index;
+
+CommandStats::CommandStats() : count(0), total_ns(0), max_ns(0)
+{
+	for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+		this->buckets[i] = 0;
+}
+
+void CommandStats::record(unsigned long ns)
+{
+	this->count++;
+	this->total_ns += ns;
+	if (ns > this->max_ns)
+		this->max_ns = ns;
+
+	size_t bucket = 0;
+	for (unsigned long us = ns / 1000; us > 0 && bucket < LATENCY_BUCKETS - 1; us >>= 1)
+		bucket++;
+	this->buckets[bucket]++;
+}
+
+static unsigned long monotonicNs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long>(ts.tv_sec) * 1000000000UL + ts.tv_nsec;
+}
+
+size_t Server::commandCount(void)
+{
+	return COMMAND_COUNT;
+}
+
+CommandSpec const *Server::findCommand(IrcToken const &verb)
+{
+	if (verb.empty())
+		return NULL;
+
+	size_t slot = commandHash(verb.data, verb.length);
+	while (g_command_index.slots[slot] != -1)
+	{
+		CommandSpec const *spec = &g_commands[g_command_index.slots[slot]];
+		if (strlen(spec->name) == verb.length \
+			&& strncasecmp(spec->name, verb.data, verb.length) == 0)
+			return spec;
+		slot = (slot + 1) & (COMMAND_SLOTS - 1);
+	}
+	return NULL;
+}
+
+// Returns false if the client was removed while running the command
+bool Server::executeCommand(int client_fd, IrcMessage const &msg)
+{
+	Client *client = this->getClient(client_fd);
+	if (!client)
+		return false;
+	client->setLastActivity(monotonicMs());
+
+	CommandSpec const *spec = findCommand(msg.getCommand());
+	if (!spec)
+		return true; // Unknown commands are ignored
+
+	if (spec->needs_registration && !client->isRegistered())
+	{
+		this->_sendErrorReply(client_fd, ERR_NOTREGISTERED, \
+			"You have not registered");
+		return true;
+	}
+	if (spec->min_params > 0 && (msg.paramCount() < spec->min_params \
+		|| msg.param(spec->min_params - 1).empty()))
+	{
+		this->_sendErrorReply(client_fd, ERR_NEEDMOREPARAMS, \
+			spec->name, "Not enough parameters");
+		return true;
+	}
+
+	unsigned long start = monotonicNs();
+	if (spec->handler)
+		(this->*spec->handler)(msg, client_fd);
+	this->_command_stats[spec - g_commands].record(monotonicNs() - start);
+
+	return (this->getClient(client_fd) == client);
+}
+
+// STATS m: one line per command used so far, with its latency histogram
+void Server::_reportCommandStats(Client *client)
+{
+	std::string prefix = ":" + _server_name + " ";
+
+	for (size_t i = 0; i < this->_command_stats.size(); i++)
+	{
+		CommandStats const &stats = this->_command_stats[i];
+		if (stats.count == 0)
+			continue;
+
+		std::ostringstream oss;
+		oss << prefix << RPL_STATSCOMMANDS << " " << client->getNickname() \
+			<< " " << g_commands[i].name << " " << stats.count \
+			<< " :avg_us " << std::fixed << std::setprecision(2) \
+			<< static_cast<double>(stats.total_ns) / stats.count / 1000 \
+			<< " max_us " << static_cast<double>(stats.max_ns) / 1000 \
+			<< " hist";
+		for (size_t b = 0; b < LATENCY_BUCKETS; b++)
+		{
+			if (stats.buckets[b] == 0)
+				continue;
+			if (b == LATENCY_BUCKETS - 1)
+				oss << " >=" << (1UL << (b - 1)) << "us:" << stats.buckets[b];
+			else
+				oss << " <" << (1UL << b) << "us:" << stats.buckets[b];
+		}
+		oss << "\r\n";
+		this->sendToClient(client, oss.str());
+	}
+}
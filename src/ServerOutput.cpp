@@ -0,0 +1,185 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ServerOutput.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 11:20:05 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 11:20:05 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Server.hpp"
+
+void Server::sendToClient(Client *client, SharedMessage const &message)
+{
+	if (!client)
+		return;
+
+	// Queues are only touched by the owning shard, which takes it from here
+	if (client->getShard() != this->_currentShard())
+	{
+		client->getShard()->post(client, message);
+		return;
+	}
+
+	// Clients being dropped don't get any more output
+	if (client->hasQuitReason())
+		return;
+
+	// A client that stopped reading is dropped instead of growing forever.
+	// Shared lines are counted once in the server wide budget.
+	size_t queued = client->getSendQBytes();
+	if (queued + message.length() > this->_config.sendq_max \
+		|| (queued > 0 && SharedMessage::getLiveBytes() \
+			> this->_config.sendq_total_max))
+	{
+		logMessage("SendQ exceeded for FD = ", YELLOW, \
+			itoa(client->getFd()) + " (" + itoa(queued) + " bytes)", WHITE, WARN);
+		this->_scheduleQuit(client, "SendQ exceeded");
+		return;
+	}
+
+	client->queueMessage(message);
+
+	// Everything queued this tick goes out in one writev() at the end of it.
+	// With IO_WRITE armed the writable event flushes it instead.
+	if (!(client->getWatchedEvents() & IO_WRITE))
+		this->_scheduleFlush(client);
+}
+
+// Single recipient replies
+void Server::sendToClient(Client *client, std::string const &message)
+{
+	if (client)
+		this->sendToClient(client, SharedMessage(message));
+}
+
+void Server::sendToClient(Client *client, Reply const &reply)
+{
+	if (!client)
+		return;
+	// A long topic or nick list ran past 512 bytes and lost its tail
+	if (reply.truncated() && this->_currentShard())
+		this->_currentShard()->stats.replies_truncated++;
+	this->sendToClient(client, SharedMessage(reply.data(), reply.length()));
+}
+
+void Server::sendToClient(int client_fd, std::string const &message)
+{
+	this->sendToClient(this->getClient(client_fd), message);
+}
+
+void Server::_scheduleFlush(Client *client)
+{
+	if (client->isFlushScheduled())
+		return;
+	client->setFlushScheduled(true);
+	client->getShard()->flush_queue.push_back(client->getFd());
+}
+
+void Server::_flushPending(void)
+{
+	// Both vectors keep their buffers, so a busy tick costs no allocation
+	Shard *shard = this->_currentShard();
+	std::vector<int> &pending = shard->flushing;
+	pending.swap(shard->flush_queue);
+
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		Client *client = this->getClient(pending[i]);
+
+		// A newer connection on the same fd was never scheduled
+		if (client && client->isFlushScheduled())
+			this->_flushClient(client);
+	}
+	pending.clear();
+}
+
+// Output produced while handling the ready events is written now, then
+// failed clients are dropped (which queues QUITs, hence the loop)
+void Server::_endOfTick(void)
+{
+	do
+	{
+		this->_flushPending();
+		this->_processPendingQuits();
+	} while (!this->_currentShard()->flush_queue.empty());
+}
+
+void Server::_flushClient(Client *client)
+{
+	client->setFlushScheduled(false);
+
+	size_t queued = client->getSendQBytes();
+	Shard *shard = client->getShard();
+	int status = client->flushSendQueue(shard->stats.write_calls);
+	shard->stats.bytes_out += queued - client->getSendQBytes();
+
+	if (status < 0)
+	{
+		logMessage("ERROR: ", RED, "Failed to send to FD = " \
+			+ itoa(client->getFd()), YELLOW, ERR);
+		this->_scheduleQuit(client, "Write error");
+		return;
+	}
+
+	// Last reply of a closing client is out: send FIN, wait for the peer's
+	if (status == 0 && client->isClosing())
+		shutdown(client->getFd(), SHUT_WR);
+
+	// Only ask for writability while something is waiting to be sent
+	int events = IO_READ;
+	if (status > 0)
+		events |= IO_WRITE;
+	if (events != client->getWatchedEvents())
+	{
+		shard->reactor->modify(client->getFd(), events);
+		client->setWatchedEvents(events);
+	}
+}
+
+void Server::_scheduleQuit(Client *client, std::string const &reason)
+{
+	if (client->hasQuitReason())
+		return;
+	client->setQuitReason(reason);
+	client->getShard()->pending_quits.push_back(client->getFd());
+}
+
+// Drops a client once its queued replies are written, without stalling the
+// loop: the socket is half closed after the last write and the client is
+// removed when the peer closes too or after CLOSE_LINGER seconds
+void Server::_closeClient(Client *client)
+{
+	if (client->isClosing())
+		return;
+	client->setClosing(true);
+	this->_flushClient(client);
+	this->_armClientTimer(client, CLOSE_LINGER);
+}
+
+void Server::_processPendingQuits(void)
+{
+	Shard *shard = this->_currentShard();
+	if (shard->pending_quits.empty())
+		return;
+
+	// Quitting can fail more writes and schedule more quits
+	ScopedLock world(this->_world_lock);
+	while (!shard->pending_quits.empty())
+	{
+		std::vector<int> quits;
+		quits.swap(shard->pending_quits);
+
+		for (size_t i = 0; i < quits.size(); i++)
+		{
+			Client *client = this->getClient(quits[i]);
+
+			// The fd may already belong to a newer connection
+			if (client && client->hasQuitReason())
+				this->quitServer(quits[i], client->getQuitReason());
+		}
+	}
+}
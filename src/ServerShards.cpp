@@ -0,0 +1,260 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ServerShards.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 17:12:40 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 17:12:40 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Server.hpp"
+
+// Shard run by the calling thread
+static pthread_key_t g_shard_key;
+static pthread_once_t g_shard_key_once = PTHREAD_ONCE_INIT;
+
+static void createShardKey(void)
+{
+	pthread_key_create(&g_shard_key, NULL);
+}
+
+Shard *Server::_currentShard(void)
+{
+	pthread_once(&g_shard_key_once, createShardKey);
+	return static_cast<Shard *>(pthread_getspecific(g_shard_key));
+}
+
+void Server::_enterShard(Shard *shard)
+{
+	pthread_once(&g_shard_key_once, createShardKey);
+	pthread_setspecific(g_shard_key, shard);
+}
+
+void *Server::_shardMain(void *shard)
+{
+	Shard *self = static_cast<Shard *>(shard);
+	self->server->_runShard(self);
+	return NULL;
+}
+
+// Shard 0 runs on the calling thread, the others get one thread each
+void Server::run()
+{
+	// Signals are only handled by the main thread
+	sigset_t blocked;
+	sigset_t previous;
+	sigemptyset(&blocked);
+	sigaddset(&blocked, SIGINT);
+	sigaddset(&blocked, SIGTERM);
+	sigaddset(&blocked, SIGTSTP);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+
+	size_t started = 1;
+	for (; started < this->_shards.size(); started++)
+	{
+		Shard *shard = this->_shards[started];
+		if (pthread_create(&shard->thread, NULL, &Server::_shardMain, shard) != 0)
+		{
+			logMessage("ERROR: ", RED, "Failed to start event loop thread!", \
+				YELLOW, ERR);
+			this->stop();
+			break;
+		}
+	}
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+	this->_runShard(this->_shards[0]);
+
+	for (size_t i = 1; i < started; i++)
+		pthread_join(this->_shards[i]->thread, NULL);
+}
+
+// Async signal safe: every loop sees the flag once its wait() returns
+void Server::stop(void)
+{
+	__sync_lock_test_and_set(&this->_stopping, 1);
+	for (size_t i = 0; i < this->_shards.size(); i++)
+		this->_shards[i]->wake();
+}
+
+// Async signal safe: each shard drops its own clients
+void Server::disconnectAll(void)
+{
+	__sync_fetch_and_add(&this->_disconnect_request, 1);
+	for (size_t i = 0; i < this->_shards.size(); i++)
+		this->_shards[i]->wake();
+}
+
+void Server::_runShard(Shard *shard)
+{
+	std::vector<ReactorEvent> ready;
+
+	_enterShard(shard);
+
+	while (!__sync_fetch_and_add(&this->_stopping, 0))
+	{
+		// Sleep until the next client timer is due, or indefinitely
+		int timeout = shard->timers.nextTimeout(monotonicMs());
+		timeout = this->_resumeAccept(shard, timeout);
+		int ready_count = shard->reactor->wait(ready, timeout);
+		if (ready_count == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			logMessage("ERROR: ", RED, "Poll failed!", YELLOW, ERR);
+			this->stop();
+			break;
+		}
+		int disconnect_request = __sync_fetch_and_add( \
+			&this->_disconnect_request, 0);
+		if (shard->disconnect_seen != disconnect_request)
+		{
+			shard->disconnect_seen = disconnect_request;
+			if (shard->index == 0)
+				logMessage("\nReceived SIGTSTP (Ctrl+Z). ", RED, \
+					"Server suspending... Warning - It won't be possible to " \
+					"recover this connection - use Ctrl+C to quit.", YELLOW);
+			this->_disconnectShard(shard);
+		}
+
+		// Only the ready descriptors are visited
+		for (size_t i = 0; i < ready.size(); i++)
+		{
+			int fd = ready[i].fd;
+			int events = ready[i].events;
+
+			if (fd == shard->listen_fd)
+			{
+				if (events & IO_READ)
+					this->_acceptNewClient();
+				continue;
+			}
+			if (fd == shard->getWakeFd())
+			{
+				// Clear first, a line posted meanwhile wakes us again
+				shard->clearWakeup();
+				this->_deliverMail(shard);
+				continue;
+			}
+			// Skip events of clients removed earlier in this batch
+			if (!this->getClient(fd))
+				continue;
+			if (events & IO_READ)
+				this->_handleClientData(fd);
+			else if (events & IO_HANGUP)
+			{
+				ScopedLock world(this->_world_lock);
+				this->_removeClient(fd); //Client disconnected by socket error
+				continue;
+			}
+			// Socket drained some output, push the rest of the queue
+			Client *client = this->getClient(fd);
+			if (client && (events & IO_WRITE))
+				this->_flushClient(client);
+		}
+		this->_expireTimers(shard);
+		this->_endOfTick();
+	}
+}
+
+// Lines other shards produced for our clients
+void Server::_deliverMail(Shard *shard)
+{
+	std::vector<MailItem> &mail = shard->mail;
+	shard->takeMail(mail);
+
+	for (size_t i = 0; i < mail.size(); i++)
+	{
+		Client **client = shard->clients.find(mail[i].fd);
+
+		// The client may have left (and its fd been reused) meanwhile
+		if (!client || (*client)->getId() != mail[i].client_id)
+			continue;
+
+		// A busy sender can post far more than one tick's worth: write out
+		// what the socket takes before the sendq limit judges the client
+		if ((*client)->getSendQBytes() + mail[i].message.length() \
+			> this->_config.sendq_max)
+			this->_flushClient(*client);
+		this->sendToClient(*client, mail[i].message);
+	}
+	mail.clear(); // Lets go of the lines, not of the buffer
+}
+
+// Drops every client of the shard (SIGTSTP)
+void Server::_disconnectShard(Shard *shard)
+{
+	// Collect first, quitServer() erases from the client table
+	std::vector<int> fds;
+	for (size_t i = 0; i < shard->clients.size(); i++)
+		fds.push_back(shard->clients.fdAt(i));
+	if (fds.empty())
+		return;
+
+	ScopedLock world(this->_world_lock);
+	for (size_t i = 0; i < fds.size(); i++)
+		this->quitServer(fds[i], "Server suspending");
+}
+
+void Server::_armClientTimer(Client *client, size_t seconds)
+{
+	client->getShard()->timers.schedule(&client->getTimer(), \
+		monotonicMs() + seconds * 1000);
+}
+
+// Only the timers due are visited, however many clients the shard holds
+void Server::_expireTimers(Shard *shard)
+{
+	std::vector<int> expired;
+	shard->timers.advance(monotonicMs(), expired);
+	if (expired.empty())
+		return;
+
+	ScopedLock world(this->_world_lock);
+	for (size_t i = 0; i < expired.size(); i++)
+	{
+		Client *client = this->getClient(expired[i]);
+		if (client)
+			this->_clientTimer(client);
+	}
+}
+
+// A client has a single timer: the registration deadline, then the next
+// keepalive check, then the deadline for the PONG (or the close linger)
+void Server::_clientTimer(Client *client)
+{
+	int client_fd = client->getFd();
+
+	if (client->isClosing())
+	{
+		this->_removeClient(client_fd);
+		return;
+	}
+	if (!client->isRegistered())
+	{
+		this->quitServer(client_fd, "Registration timeout");
+		return;
+	}
+	if (client->getPingSent())
+	{
+		this->quitServer(client_fd, "Ping timeout: " \
+			+ itoa(this->_config.ping_timeout) + " seconds");
+		return;
+	}
+
+	// Activity since the timer was armed pushes the check back. Both sides
+	// use the monotonic clock, so a wall clock step can't fake idleness.
+	unsigned long due = client->getLastActivity() \
+		+ this->_config.ping_interval * 1000;
+	if (due > monotonicMs())
+	{
+		client->getShard()->timers.schedule(&client->getTimer(), due);
+		return;
+	}
+	this->sendToClient(client, Reply().text("PING").trailing(this->_server_name));
+	client->setPingSent(monotonicMs());
+	this->_armClientTimer(client, this->_config.ping_timeout);
+}
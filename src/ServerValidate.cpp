@@ -79,26 +79,22 @@ std::string Server::_checkDoubles(std::string const &nickname, int client_fd)
 	if (space_pos != std::string::npos)
 		modifiedNickname.erase(space_pos);
 	
-	if (!_isValidNickname(modifiedNickname))
-	{
+	bool valid = _isValidNickname(modifiedNickname);
+	if (!valid)
 		this->_sendErrorReply(client_fd, ERR_ERRONEUSNICKNAME, \
 			"Erroneous nickname");
-		return modifiedNickname;
-	}
 	
-	// Checking double nicks
-	std::map<int, Client*>::iterator it;
-	for (it = this->_clients.begin(); it != this->_clients.end(); it++)
+	// Checking double nicks, the index keeps registered nicks unique
+	Client **owner = this->_nicks.find(modifiedNickname);
+	if (owner && (*owner)->getFd() != client_fd)
 	{
-		Client *client = it->second;
-		// Check if the client exists, if it is active and has the same nick
-		if (client && client->getFd() != client_fd \
-			&& !client->getNickname().empty() \
-			&& client->getNickname() == modifiedNickname)
+		if (valid)
+			this->_sendErrorReply(client_fd, ERR_NICKNAMEINUSE, modifiedNickname, \
+				"Nickname is already in use");
+		while (owner && (*owner)->getFd() != client_fd)
 		{
-			this->_sendErrorReply(client_fd, ERR_NICKNAMEINUSE, modifiedNickname + " :Nickname is already in use");
 			modifiedNickname += "_";
-			break;
+			owner = this->_nicks.find(modifiedNickname);
 		}
 	}
 	return modifiedNickname;
@@ -0,0 +1,165 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Shard.cpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 17:12:40 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 17:12:40 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Shard.hpp"
+#include "../include/Client.hpp"
+#include "../include/ScopedLock.hpp"
+
+#include <fcntl.h>
+
+ShardStats::ShardStats() : commands(0), read_calls(0), write_calls(0), \
+		bytes_out(0), replies_truncated(0), accepted(0), accept_peak(0), accept_queue_peak(0), \
+		accept_queue_full(0), accept_queue_limit(0), accept_failures(0), \
+		accept_second(0), accepted_second(0), accepted_last(0)
+{
+}
+
+void ShardStats::countAccepts(unsigned long count, time_t now)
+{
+	if (now != this->accept_second)
+	{
+		this->accepted_last = (now == this->accept_second + 1) \
+			? this->accepted_second : 0;
+		this->accept_second = now;
+		this->accepted_second = 0;
+	}
+	this->accepted += count;
+	this->accepted_second += count;
+	if (this->accepted_second > this->accept_peak)
+		this->accept_peak = this->accepted_second;
+}
+
+// Connections accepted during the last complete second
+unsigned long ShardStats::acceptRate(time_t now) const
+{
+	if (now == this->accept_second)
+		return this->accepted_last;
+	if (now == this->accept_second + 1)
+		return this->accepted_second;
+	return 0;
+}
+
+// A full queue means the kernel is dropping new handshakes
+void ShardStats::countAcceptQueue(unsigned long depth, unsigned long limit)
+{
+	this->accept_queue_limit = limit;
+	if (depth > this->accept_queue_peak)
+		this->accept_queue_peak = depth;
+	if (limit > 0 && depth >= limit)
+		this->accept_queue_full++;
+}
+
+// Counters are only written by their shard's thread, other threads read
+// them through here one atomic load at a time
+template <typename T>
+static T loadCounter(T const &counter)
+{
+	return __sync_fetch_and_add(const_cast<T *>(&counter), 0);
+}
+
+// Fields may come from slightly different moments, fine for STATS
+ShardStats ShardStats::snapshot(void) const
+{
+	ShardStats copy;
+
+	copy.commands = loadCounter(this->commands);
+	copy.read_calls = loadCounter(this->read_calls);
+	copy.write_calls = loadCounter(this->write_calls);
+	copy.bytes_out = loadCounter(this->bytes_out);
+	copy.replies_truncated = loadCounter(this->replies_truncated);
+	copy.accepted = loadCounter(this->accepted);
+	copy.accept_peak = loadCounter(this->accept_peak);
+	copy.accept_queue_peak = loadCounter(this->accept_queue_peak);
+	copy.accept_queue_full = loadCounter(this->accept_queue_full);
+	copy.accept_queue_limit = loadCounter(this->accept_queue_limit);
+	copy.accept_failures = loadCounter(this->accept_failures);
+	copy.accept_second = loadCounter(this->accept_second);
+	copy.accepted_second = loadCounter(this->accepted_second);
+	copy.accepted_last = loadCounter(this->accepted_last);
+	return copy;
+}
+
+Shard::Shard(Server *server, int index) : server(server), index(index), \
+	listen_fd(-1), reactor(NULL), disconnect_seen(0), accept_resume_ms(0), \
+	accept_logged_ms(0), accept_unlogged(0), thread()
+{
+	pthread_mutex_init(&this->_mailbox_lock, NULL);
+	this->_wake_fds[0] = -1;
+	this->_wake_fds[1] = -1;
+}
+
+Shard::~Shard()
+{
+	if (this->listen_fd >= 0)
+		close(this->listen_fd);
+	if (this->_wake_fds[0] >= 0)
+		close(this->_wake_fds[0]);
+	if (this->_wake_fds[1] >= 0)
+		close(this->_wake_fds[1]);
+	delete this->reactor;
+	pthread_mutex_destroy(&this->_mailbox_lock);
+}
+
+bool Shard::initWakeup(void)
+{
+	if (pipe(this->_wake_fds) == -1)
+		return false;
+	for (int i = 0; i < 2; i++)
+		if (fcntl(this->_wake_fds[i], F_SETFL, O_NONBLOCK) == -1)
+			return false;
+	return true;
+}
+
+int Shard::getWakeFd(void) const
+{
+	return this->_wake_fds[0];
+}
+
+// Async signal safe, also used to interrupt wait() on shutdown
+void Shard::wake(void)
+{
+	char byte = 0;
+	ssize_t written = write(this->_wake_fds[1], &byte, 1);
+	(void)written; // A full pipe already means a wake up is pending
+}
+
+void Shard::clearWakeup(void)
+{
+	char buffer[64];
+	while (read(this->_wake_fds[0], buffer, sizeof(buffer)) > 0)
+		;
+}
+
+// Called by other shards, only the first line of a batch wakes the owner
+void Shard::post(Client *client, SharedMessage const &message)
+{
+	MailItem item;
+	item.fd = client->getFd();
+	item.client_id = client->getId();
+	item.message = message;
+
+	bool was_empty;
+	{
+		ScopedLock lock(this->_mailbox_lock);
+		was_empty = this->_mailbox.empty();
+		this->_mailbox.push_back(item);
+	}
+	if (was_empty)
+		this->wake();
+}
+
+void Shard::takeMail(std::vector<MailItem> &out)
+{
+	out.clear();
+	ScopedLock lock(this->_mailbox_lock);
+	out.swap(this->_mailbox);
+}
@@ -0,0 +1,191 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SharedMessage.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 15:16:02 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 15:16:02 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/SharedMessage.hpp"
+#include "../include/Utils.hpp"
+
+#include <cstring>
+#include <new>
+#include <pthread.h>
+
+#define BLOCK_SIZE		(sizeof(size_t) * 2 + MAX_MESSAGE_LENGTH)	// Header, line
+#define BLOCK_CACHE_MAX	512	// Spare blocks one thread keeps, about 270 KB
+
+// Spare blocks of the calling thread, linked through their first bytes.
+// Each shard thread has its own list, so no lock is taken: a block freed
+// by another shard just joins that shard's list. A burst past the cap goes
+// back to the heap instead of staying resident.
+struct BlockCache
+{
+	void *head;
+	size_t count;
+};
+
+static pthread_key_t g_cache_key;
+static pthread_once_t g_cache_key_once = PTHREAD_ONCE_INIT;
+
+static void emptyCache(BlockCache *cache)
+{
+	while (cache->head)
+	{
+		void *next = *static_cast<void **>(cache->head);
+		::operator delete(cache->head);
+		cache->head = next;
+	}
+	cache->count = 0;
+}
+
+static void destroyCache(void *cache)
+{
+	emptyCache(static_cast<BlockCache *>(cache));
+	delete static_cast<BlockCache *>(cache);
+}
+
+// The thread's list is freed when it exits
+static void createCacheKey(void)
+{
+	pthread_key_create(&g_cache_key, destroyCache);
+}
+
+static BlockCache *threadCache(void)
+{
+	pthread_once(&g_cache_key_once, createCacheKey);
+	BlockCache *cache = static_cast<BlockCache *>(pthread_getspecific(g_cache_key));
+	if (!cache)
+	{
+		cache = new BlockCache();
+		cache->head = NULL;
+		cache->count = 0;
+		pthread_setspecific(g_cache_key, cache);
+	}
+	return cache;
+}
+
+// Protocol sized lines all take a block of BLOCK_SIZE, so any spare fits
+static void *allocateBlock(size_t size)
+{
+	if (size > BLOCK_SIZE)
+		return ::operator new(size);
+	BlockCache *cache = threadCache();
+	if (!cache->head)
+		return ::operator new(BLOCK_SIZE);
+	void *block = cache->head;
+	cache->head = *static_cast<void **>(block);
+	cache->count--;
+	return block;
+}
+
+static void freeBlock(void *block, size_t size)
+{
+	BlockCache *cache = (size <= BLOCK_SIZE) ? threadCache() : NULL;
+
+	if (!cache || cache->count >= BLOCK_CACHE_MAX)
+	{
+		::operator delete(block);
+		return;
+	}
+	*static_cast<void **>(block) = cache->head;
+	cache->head = block;
+	cache->count++;
+}
+
+size_t SharedMessage::_live_bytes = 0;
+
+SharedMessage::SharedMessage() : _buffer(NULL)
+{
+}
+
+SharedMessage::SharedMessage(std::string const &data) : _buffer(NULL)
+{
+	this->_create(data.data(), data.size());
+}
+
+SharedMessage::SharedMessage(const char *data, size_t length) : _buffer(NULL)
+{
+	this->_create(data, length);
+}
+
+void SharedMessage::_create(const char *data, size_t length)
+{
+	if (length == 0)
+		return;
+
+	this->_buffer = static_cast<Buffer *>(allocateBlock(sizeof(Buffer) + length));
+	this->_buffer->refs = 1;
+	this->_buffer->length = length;
+	memcpy(this->_buffer + 1, data, length);
+	__sync_fetch_and_add(&_live_bytes, length);
+}
+
+SharedMessage::SharedMessage(SharedMessage const &other) \
+	: _buffer(other._buffer)
+{
+	if (this->_buffer)
+		__sync_fetch_and_add(&this->_buffer->refs, 1);
+}
+
+SharedMessage &SharedMessage::operator=(SharedMessage const &other)
+{
+	if (this->_buffer != other._buffer)
+	{
+		this->_release();
+		this->_buffer = other._buffer;
+		if (this->_buffer)
+			__sync_fetch_and_add(&this->_buffer->refs, 1);
+	}
+	return *this;
+}
+
+SharedMessage::~SharedMessage()
+{
+	this->_release();
+}
+
+void SharedMessage::_release(void)
+{
+	if (this->_buffer && __sync_sub_and_fetch(&this->_buffer->refs, 1) == 0)
+	{
+		size_t length = this->_buffer->length;
+		__sync_fetch_and_sub(&_live_bytes, length);
+		freeBlock(this->_buffer, sizeof(Buffer) + length);
+	}
+	this->_buffer = NULL;
+}
+
+// The main thread never runs the key destructor, the server calls this
+void SharedMessage::releaseCache(void)
+{
+	pthread_once(&g_cache_key_once, createCacheKey);
+	BlockCache *cache = static_cast<BlockCache *>(pthread_getspecific(g_cache_key));
+	if (cache)
+		emptyCache(cache);
+}
+
+const char *SharedMessage::data(void) const
+{
+	return this->_buffer ? reinterpret_cast<const char *>(this->_buffer + 1) : "";
+}
+
+size_t SharedMessage::length(void) const
+{
+	return this->_buffer ? this->_buffer->length : 0;
+}
+
+bool SharedMessage::empty(void) const
+{
+	return (this->length() == 0);
+}
+
+size_t SharedMessage::getLiveBytes(void)
+{
+	return __sync_add_and_fetch(&_live_bytes, 0);
+}
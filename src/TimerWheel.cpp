@@ -0,0 +1,151 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: crocha-s <crocha-s@student.42.fr>          #+#  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026-10-18 18:52:07 by crocha-s          #+#    #+#             */
+/*   Updated: 2026-10-18 18:52:07 by crocha-s         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/TimerWheel.hpp"
+#include "../include/Utils.hpp"
+
+#define TIMER_MASK		(TIMER_SLOTS - 1)
+#define TIMER_SPAN		(1UL << (TIMER_BITS * TIMER_LEVELS)) //Ticks covered
+
+TimerNode::TimerNode() : prev(NULL), next(NULL), expires(0), fd(-1)
+{
+}
+
+bool TimerNode::isArmed() const
+{
+	return (this->next != NULL);
+}
+
+TimerWheel::TimerWheel() : _current(monotonicMs() / TIMER_TICK_MS), _count(0)
+{
+	for (int level = 0; level < TIMER_LEVELS; level++)
+	{
+		for (int slot = 0; slot < TIMER_SLOTS; slot++)
+		{
+			this->_slots[level][slot].prev = &this->_slots[level][slot];
+			this->_slots[level][slot].next = &this->_slots[level][slot];
+		}
+	}
+}
+
+// Level chosen by how far away the tick is, slot by the tick bits of it
+void TimerWheel::_insert(TimerNode *node)
+{
+	unsigned long delta = node->expires - this->_current;
+	int level = 0;
+
+	while (level < TIMER_LEVELS - 1 \
+		&& delta >= (1UL << (TIMER_BITS * (level + 1))))
+		level++;
+
+	TimerNode *head = &this->_slots[level] \
+		[(node->expires >> (TIMER_BITS * level)) & TIMER_MASK];
+	node->prev = head->prev;
+	node->next = head;
+	head->prev->next = node;
+	head->prev = node;
+}
+
+// Re-files the timers of the level's current slot, all now due sooner
+void TimerWheel::_cascade(int level)
+{
+	TimerNode *head = &this->_slots[level] \
+		[(this->_current >> (TIMER_BITS * level)) & TIMER_MASK];
+	TimerNode *node = head->next;
+
+	head->prev = head;
+	head->next = head;
+	while (node != head)
+	{
+		TimerNode *next = node->next;
+		this->_insert(node);
+		node = next;
+	}
+}
+
+// Re-arming an armed timer just moves it
+void TimerWheel::schedule(TimerNode *node, unsigned long due_ms)
+{
+	this->cancel(node);
+
+	unsigned long expires = (due_ms + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+	if (expires <= this->_current)
+		expires = this->_current + 1; //Overdue: next tick
+	if (expires - this->_current >= TIMER_SPAN)
+		expires = this->_current + TIMER_SPAN - 1;
+
+	node->expires = expires;
+	this->_insert(node);
+	this->_count++;
+}
+
+void TimerWheel::cancel(TimerNode *node)
+{
+	if (!node->isArmed())
+		return;
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+	node->prev = NULL;
+	node->next = NULL;
+	this->_count--;
+}
+
+// Walks the ticks up to now; the fds of the timers due are appended
+void TimerWheel::advance(unsigned long now_ms, std::vector<int> &expired)
+{
+	unsigned long target = now_ms / TIMER_TICK_MS;
+
+	if (this->_count == 0 && target > this->_current)
+		this->_current = target; //Nothing to move, skip the idle stretch
+	while (this->_current < target)
+	{
+		this->_current++;
+
+		// A finer wheel wrapped: pull the current slot of the coarser one down
+		for (int level = 1; level < TIMER_LEVELS; level++)
+		{
+			if ((this->_current & ((1UL << (TIMER_BITS * level)) - 1)) != 0)
+				break;
+			this->_cascade(level);
+		}
+
+		TimerNode *head = &this->_slots[0][this->_current & TIMER_MASK];
+		while (head->next != head)
+		{
+			TimerNode *node = head->next;
+			this->cancel(node);
+			expired.push_back(node->fd);
+		}
+	}
+}
+
+// Milliseconds the event loop may sleep, -1 when no timer is armed.
+// Past the first wheel the answer is its wrap, where the next cascade runs.
+int TimerWheel::nextTimeout(unsigned long now_ms) const
+{
+	if (this->_count == 0)
+		return -1;
+
+	unsigned long tick = this->_current + 1;
+	while ((tick & TIMER_MASK) != 0 \
+		&& this->_slots[0][tick & TIMER_MASK].next \
+			== &this->_slots[0][tick & TIMER_MASK])
+		tick++;
+
+	unsigned long due_ms = tick * TIMER_TICK_MS;
+	return (due_ms > now_ms) ? static_cast<int>(due_ms - now_ms) : 0;
+}
+
+size_t TimerWheel::size() const
+{
+	return this->_count;
+}
@@ -12,21 +12,6 @@
 
 #include "../include/Utils.hpp"
 
-// Log Generation functions
-void logMessage(std::string msg, std::string msg_color, std::string args, std::string args_color, int type)
-{
-	if (type == ERR)
-	{
-		std::cerr << msg_color << msg << RESET;
-		std::cerr << args_color << args << RESET << std::endl;
-	}
-	else
-	{
-		std::cout << msg_color << msg << RESET;
-		std::cout << args_color << args << RESET << std::endl;
-	}
-}
-
 // Conversions and validation
 std::string itoa(int number)
 {
@@ -35,6 +20,14 @@ std::string itoa(int number)
 	return oss.str();
 }
 
+// Milliseconds since boot, immune to clock changes
+unsigned long monotonicMs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long>(ts.tv_sec) * 1000UL + ts.tv_nsec / 1000000;
+}
+
 bool isNum(const std::string &str)
 {
 	if (str.empty())
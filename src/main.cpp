@@ -14,46 +14,27 @@
 #include "../include/Utils.hpp"
 
 Server *g_server = NULL;
+volatile sig_atomic_t g_stop_signal = 0; // Signal that stopped the server
 
+// Only async signal safe work here: flags and the shards' wake pipes.
+// What happened is logged by main() and the event loops.
 void signalHandler(int signal_type)
 {
 	switch (signal_type)
 	{
 	case SIGINT: // CTRL + C
-		logMessage("\nReceived SIGINT (Ctrl+C). ", RED, \
-			"Shutting down server gracefully...", YELLOW);
-		if(g_server)
-			g_server->cleanUp();
-		logMessage("Server shutdown complete.", GREEN, "", WHITE);
-		exit(0);
-		break;
-
-	case SIGTSTP: // CTRL + Z
-		logMessage("\nReceived SIGTSTP (Ctrl+Z). ", RED, \
-			"Server suspending... Warning - It won't be possible to recover this connection - use Ctrl+C to quit.", YELLOW);
-		if(g_server)
-			g_server->cleanUp();
-		break;
-
 	case SIGTERM: // System shutdown
-		logMessage("\nReceived SIGTERM. ", RED, \
-			"Shutting down server...", YELLOW);
+		g_stop_signal = signal_type;
 		if (g_server)
-		{
-			delete g_server;
-			g_server = NULL;
-		}
-		exit(0);
+			g_server->stop(); // run() returns once every event loop stopped
 		break;
 
-	case SIGPIPE: // Broken pipe
-		logMessage("\nReceived SIGPIPE. ", RED, \
-			"Broken pipe detected.", YELLOW);
+	case SIGTSTP: // CTRL + Z, each shard drops its clients
+		if (g_server)
+			g_server->disconnectAll();
 		break;
-	
+
 	default:
-		logMessage("\nReceived unknown signal: ", RED, \
-			itoa(signal_type), YELLOW);
 		break;
 	}
 }
@@ -78,12 +59,75 @@ bool checkPort(std::string &port)
 	return (true);
 }
 
+bool parseSize(std::string const &value, size_t &out)
+{
+	if (!isNum(value) || value[0] == '-' || value[0] == '+')
+		return (false);
+	out = strtoul(value.c_str(), NULL, 10);
+	return (out > 0);
+}
+
+// Optional tunables given as --name=value after port and password
+bool parseOptions(int argc, char **argv, ServerConfig &config)
+{
+	for (int i = 3; i < argc; i++)
+	{
+		std::string option = argv[i];
+		size_t equal = option.find('=');
+		std::string name = option.substr(0, equal);
+		std::string value = (equal == std::string::npos) ? "" \
+			: option.substr(equal + 1);
+		bool valid = false;
+
+		if (name == "--sendq")
+			valid = parseSize(value, config.sendq_max);
+		else if (name == "--sendq-total")
+			valid = parseSize(value, config.sendq_total_max);
+		else if (name == "--backlog")
+			valid = parseSize(value, config.listen_backlog) \
+				&& config.listen_backlog <= MAX_LISTEN_BACKLOG;
+		else if (name == "--pool-clients")
+			valid = parseSize(value, config.pool_clients);
+		else if (name == "--pool-channels")
+			valid = parseSize(value, config.pool_channels);
+		else if (name == "--ping-interval")
+			valid = parseSize(value, config.ping_interval);
+		else if (name == "--ping-timeout")
+			valid = parseSize(value, config.ping_timeout);
+		else if (name == "--registration-timeout")
+			valid = parseSize(value, config.registration_timeout);
+		else if (name == "--log-level")
+		{
+			int level;
+			valid = logParseLevel(value, level);
+			if (valid)
+				logSetLevel(level);
+		}
+		else if (name == "--threads")
+			valid = parseSize(value, config.threads) \
+				&& config.threads <= MAX_THREADS;
+
+		if (!valid)
+		{
+			logMessage("ERROR: ", RED, "Invalid option: " + option, \
+				YELLOW, ERR);
+			return (false);
+		}
+	}
+	return (true);
+}
+
 int main(int argc, char **argv)
 {
-	if (argc != 3)
+	if (argc < 3)
 	{
 		logMessage("Invalid number of arguments! ", RED, \
-			"Try ./ircserv <port> <password>", YELLOW, ERR);
+			"Try ./ircserv <port> <password> [--sendq=<bytes>] " \
+			"[--sendq-total=<bytes>] [--threads=<count>] [--backlog=<count>] " \
+			"[--pool-clients=<count>] [--pool-channels=<count>] " \
+			"[--ping-interval=<s>] [--ping-timeout=<s>] " \
+			"[--registration-timeout=<s>] " \
+			"[--log-level=debug|info|warn|error]", YELLOW, ERR);
 		return (-1);
 	}
 
@@ -95,6 +139,10 @@ int main(int argc, char **argv)
 	if(!checkPort(port))
 		return (-1);
 
+	ServerConfig config;
+	if (!parseOptions(argc, argv, config))
+		return (-1);
+
 	int_port = atoi(port.c_str());
 	
 	signal(SIGINT, signalHandler);
@@ -102,15 +150,28 @@ int main(int argc, char **argv)
 	signal(SIGTERM, signalHandler);
 	signal(SIGPIPE, SIG_IGN);
 
-	Server server(int_port, pass);
+	Server server(int_port, pass, config);
 	g_server = &server;
 
-	if (server.serverInit())
-		logMessage("Server running on port: ", BLUE, port, GREEN);
-	else
+	if (!server.serverInit())
 		return (-1);
 
+	// From here on the event loops only queue their log lines
+	if (!logStart())
+		logMessage("WARNING: ", YELLOW, \
+			"Failed to start log writer, logging synchronously", WHITE, WARN);
+	logMessage("Server running on port: ", BLUE, port, GREEN);
+
 	server.run();
 	g_server = NULL;
+	if (g_stop_signal == SIGINT)
+		logMessage("\nReceived SIGINT (Ctrl+C). ", RED, \
+			"Shutting down server gracefully...", YELLOW);
+	else if (g_stop_signal == SIGTERM)
+		logMessage("\nReceived SIGTERM. ", RED, \
+			"Shutting down server...", YELLOW);
+	server.cleanUp();
+	logMessage("Server shutdown complete.", GREEN, "", WHITE);
+	logStop();
 	return 0;
 }